@@ -106,12 +106,13 @@ def main():
     parser = argparse.ArgumentParser(description="Builds and deploys FRC C++ programs")
     parser.add_argument(
         "target",
-        choices=["build", "deploy", "clean", "ci", "test"],
+        choices=["build", "deploy", "clean", "ci", "test", "bench"],
         help="""'build' compiles the robot program for athena and downloads missing dependencies.
         'deploy' compiles the program if it hasn't already and deploys it to a roboRIO.
         'clean' removes all build artifacts from the build folder.
         'ci' compiles the robot program for x86-64 and downloads missing dependencies.
-        'test' compiles the robot program for x86-64 and downloads missing dependencies, then runs the tests.""",
+        'test' compiles the robot program for x86-64 and downloads missing dependencies, then runs the tests.
+        'bench' compiles the robot program for x86-64 and downloads missing dependencies, then runs the benchmarks.""",
     )
     parser.add_argument(
         "-j",
@@ -153,7 +154,7 @@ def main():
             WPI_URL + "/ni-libraries", "runtime", "2020.10.1", classifier, False
         )
         download_lib(WPI_URL + "/ni-libraries", "visa", "2020.10.1", classifier)
-    elif args.target in ["ci", "test"]:
+    elif args.target in ["ci", "test", "bench"]:
         download_lib(GTEST_URL, "googletest", "1.9.0-4-437e100-1", classifier + "static")
 
     classifier += "static"
@@ -181,6 +182,30 @@ def main():
         subprocess.run(["touch", "build/generated"])
         print(" done.")
 
+    # Generate messages only tests use. They're standalone, so they stay out
+    # of the robot's Message variant.
+    if args.target in ["ci", "test"] and (
+        not os.path.exists("build/generated-test")
+        or os.path.getmtime("src/test/msgs")
+        > os.path.getmtime("build/generated-test")
+        or os.path.getmtime("python/generate_messages.py")
+        > os.path.getmtime("build/generated-test")
+    ):
+        print("Generating test PubSub messages...", end="")
+        subprocess.run(
+            [
+                sys.executable,
+                "python/generate_messages.py",
+                "--input",
+                "src/test/msgs",
+                "--output",
+                "build/generated-test",
+                "--standalone",
+            ]
+        )
+        subprocess.run(["touch", "build/generated-test"])
+        print(" done.")
+
     make_athena = ["make", "-f", "mk/Makefile-linuxathena"]
     make_x86_64 = ["make", "-f", "mk/Makefile-linuxx86-64"]
 
@@ -203,6 +228,9 @@ def main():
         purge(".", r"Robot\.log$")
 
         subprocess.run(["build/linuxx86-64/frcUserProgram"], check=True)
+    elif args.target == "bench":
+        subprocess.run(make_x86_64 + ["bench", f"-j{args.jobs}"], check=True)
+        subprocess.run(["build/linuxx86-64/frcUserProgramBench"], check=True)
 
 
 if __name__ == "__main__":
@@ -5,46 +5,414 @@
 import argparse
 import os
 import re
+from collections import namedtuple
+
+# How each scalar .msg type is stored in a packet and on the wire. The wire
+# conversions are format strings taking the value to convert. Multibyte
+# integers are big-endian on the wire, like Packet's operator<<.
+ScalarType = namedtuple(
+    "ScalarType", ["cpp_type", "wire_type", "to_wire", "from_wire", "default"]
+)
+SCALAR_TYPES = {
+    "bool": ScalarType(
+        "bool", "uint8_t", "static_cast<uint8_t>({})", "{} != 0", "false"
+    ),
+    "int8": ScalarType("int8_t", "int8_t", "{}", "{}", "0"),
+    "uint8": ScalarType("uint8_t", "uint8_t", "{}", "{}", "0"),
+    "int16": ScalarType(
+        "int16_t",
+        "uint16_t",
+        "htons(static_cast<uint16_t>({}))",
+        "static_cast<int16_t>(ntohs({}))",
+        "0",
+    ),
+    "uint16": ScalarType("uint16_t", "uint16_t", "htons({})", "ntohs({})", "0"),
+    "int32": ScalarType(
+        "int32_t",
+        "uint32_t",
+        "htonl(static_cast<uint32_t>({}))",
+        "static_cast<int32_t>(ntohl({}))",
+        "0",
+    ),
+    "uint32": ScalarType("uint32_t", "uint32_t", "htonl({})", "ntohl({})", "0"),
+    "int64": ScalarType(
+        "int64_t",
+        "uint64_t",
+        "htobe64(static_cast<uint64_t>({}))",
+        "static_cast<int64_t>(be64toh({}))",
+        "0",
+    ),
+    "uint64": ScalarType("uint64_t", "uint64_t", "htobe64({})", "be64toh({})", "0"),
+    "float32": ScalarType("float", "float", "{}", "{}", "0.0f"),
+    "float64": ScalarType("double", "double", "{}", "{}", "0.0"),
+}
+TYPE_ALIASES = {"int": "int32", "float": "float32", "double": "float64"}
+WIRE_SIZES = {
+    "int8_t": 1,
+    "uint8_t": 1,
+    "uint16_t": 2,
+    "uint32_t": 4,
+    "uint64_t": 8,
+    "float": 4,
+    "double": 8,
+}
+
+# A field of a message. count is None unless the field is a fixed-size array.
+Field = namedtuple("Field", ["type", "count", "name"])
+
+# Fields every packet starts with on the wire. PublishNode::Publish() fills in
+# topicID and sendTime.
+HEADER_FIELDS = [
+    Field("int8", None, "ID"),
+    Field("uint32", None, "topicID"),
+    Field("int64", None, "sendTime"),
+]
+
+
+def parse_msg_file(filename):
+    """Returns the list of Fields declared in a message file.
+
+    Keyword arguments:
+    filename -- path of the .msg file
+    """
+    var_regex = re.compile(r"(?P<type>\w+)\s*(\[(?P<count>\d+)\])?\s+(?P<name>\w+)")
+    fields = []
+    with open(filename, "r") as msgfile:
+        for line in msgfile:
+            # Strip comments
+            if line.find("#") != -1:
+                line = line[: line.find("#")]
+
+            match = var_regex.search(line)
+            if match:
+                type = TYPE_ALIASES.get(match.group("type"), match.group("type"))
+                count = match.group("count")
+                fields.append(
+                    Field(type, int(count) if count else None, match.group("name"))
+                )
+    return fields
+
+
+def cpp_type(field):
+    """Returns the C++ type of a field's member variable."""
+    if field.type == "string":
+        element = "std::string"
+    elif field.type in SCALAR_TYPES:
+        element = SCALAR_TYPES[field.type].cpp_type
+    else:
+        element = field.type
+    if field.count is not None:
+        return f"std::array<{element}, {field.count}>"
+    return element
+
+
+def constructor_arg_type(field):
+    """Returns the type a constructor takes a field's value as."""
+    if field.type == "string" and field.count is None:
+        return "std::string_view"
+    elif field.type in SCALAR_TYPES and field.count is None:
+        return cpp_type(field)
+    else:
+        return f"const {cpp_type(field)}&"
+
+
+def default_value(field):
+    """Returns a field's default member initializer."""
+    if field.count is None and field.type in SCALAR_TYPES:
+        return f" = {SCALAR_TYPES[field.type].default}"
+    elif field.type == "string":
+        return ""
+    else:
+        return "{}"
+
+
+def is_pod(fields, nested_types):
+    """Returns true if every field has a fixed size on the wire."""
+    for field in fields:
+        if field.type == "string":
+            return False
+        if field.type not in SCALAR_TYPES and not is_pod(
+            nested_types[field.type], nested_types
+        ):
+            return False
+    return True
+
+
+def wire_size(fields, nested_types):
+    """Returns the serialized size of fixed-size fields in bytes."""
+    size = 0
+    for field in fields:
+        if field.type in SCALAR_TYPES:
+            element_size = WIRE_SIZES[SCALAR_TYPES[field.type].wire_type]
+        else:
+            element_size = wire_size(nested_types[field.type], nested_types)
+        size += element_size * (field.count or 1)
+    return size
+
+
+def wire_struct(name, fields):
+    """Returns the definition of a packed struct with the wire layout of the
+    given fixed-size fields.
+
+    Keyword arguments:
+    name -- name of the struct
+    fields -- list of Fields
+    """
+    lines = [f"struct {name} {{"]
+    for field in fields:
+        if field.type in SCALAR_TYPES:
+            wire_type = SCALAR_TYPES[field.type].wire_type
+        else:
+            wire_type = f"{field.type}Wire"
+        count = f"[{field.count}]" if field.count is not None else ""
+        lines.append(f"    {wire_type} {field.name}{count};")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def to_wire_statements(fields, value, wire, indent):
+    """Returns statements copying fields from a value into its wire struct.
+
+    Arrays which need no byte swapping are copied with one memcpy.
+
+    Keyword arguments:
+    fields -- list of Fields
+    value -- C++ expression for the value, followed by a member access
+    wire -- C++ expression for the wire struct, followed by a member access
+    indent -- indentation of each statement
+    """
+    lines = []
+    for field in fields:
+        src = f"{value}{field.name}"
+        dst = f"{wire}{field.name}"
+        if field.type in SCALAR_TYPES:
+            scalar = SCALAR_TYPES[field.type]
+            if field.count is None:
+                lines.append(f"{dst} = {scalar.to_wire.format(src)};")
+            elif scalar.to_wire == "{}":
+                lines.append(f"std::memcpy({dst}, {src}.data(), sizeof({dst}));")
+            else:
+                lines.append(f"for (size_t i = 0; i < {field.count}; ++i) {{")
+                lines.append(f"    {dst}[i] = {scalar.to_wire.format(src + '[i]')};")
+                lines.append("}")
+        elif field.count is None:
+            lines.append(f"ToWire({src}, {dst});")
+        else:
+            lines.append(f"for (size_t i = 0; i < {field.count}; ++i) {{")
+            lines.append(f"    ToWire({src}[i], {dst}[i]);")
+            lines.append("}")
+    return "".join(f"{indent}{line}\n" for line in lines)
+
+
+def from_wire_statements(fields, wire, value, indent):
+    """Returns statements copying fields from a wire struct into a value.
+
+    Keyword arguments:
+    fields -- list of Fields
+    wire -- C++ expression for the wire struct, followed by a member access
+    value -- C++ expression for the value, followed by a member access
+    indent -- indentation of each statement
+    """
+    lines = []
+    for field in fields:
+        src = f"{wire}{field.name}"
+        dst = f"{value}{field.name}"
+        if field.type in SCALAR_TYPES:
+            scalar = SCALAR_TYPES[field.type]
+            if field.count is None:
+                lines.append(f"{dst} = {scalar.from_wire.format(src)};")
+            elif scalar.from_wire == "{}":
+                lines.append(f"std::memcpy({dst}.data(), {src}, sizeof({src}));")
+            else:
+                lines.append(f"for (size_t i = 0; i < {field.count}; ++i) {{")
+                lines.append(
+                    f"    {dst}[i] = {scalar.from_wire.format(src + '[i]')};"
+                )
+                lines.append("}")
+        elif field.count is None:
+            lines.append(f"FromWire({src}, {dst});")
+        else:
+            lines.append(f"for (size_t i = 0; i < {field.count}; ++i) {{")
+            lines.append(f"    FromWire({src}[i], {dst}[i]);")
+            lines.append("}")
+    return "".join(f"{indent}{line}\n" for line in lines)
+
+
+def stream_statements(fields, operator, value, indent):
+    """Returns statements streaming fields into or out of a Packet.
+
+    Keyword arguments:
+    fields -- list of Fields
+    operator -- "<<" to serialize or ">>" to deserialize
+    value -- C++ expression for the value, followed by a member access
+    indent -- indentation of each statement
+    """
+    lines = []
+    for field in fields:
+        if field.count is None:
+            lines.append(f"packet {operator} {value}{field.name};")
+        else:
+            ref = "const auto&" if operator == "<<" else "auto&"
+            lines.append(f"for ({ref} element : {value}{field.name}) {{")
+            lines.append(f"    packet {operator} element;")
+            lines.append("}")
+    return "".join(f"{indent}{line}\n" for line in lines)
+
+
+def nested_includes(fields, nested_types):
+    """Returns #include lines for the nested types the fields use."""
+    names = sorted({field.type for field in fields if field.type in nested_types})
+    return "".join(f'#include "communications/{name}.hpp"\n' for name in names)
+
+
+def write_type_header(output_dir, type_name, fields, nested_types):
+    """Write the header of a nested message type, which is a plain struct
+    rather than a packet.
+
+    Keyword arguments:
+    output_dir -- output directory root for source
+    type_name -- name of the type in camel case
+    fields -- list of Fields
+    nested_types -- dictionary of nested type names to their Fields
+    """
+    if not is_pod(fields, nested_types):
+        raise ValueError(f"nested type {type_name} can't contain strings")
+
+    with open(f"{type_name}.hpp", "w") as output:
+        output.write(
+            f"""#pragma once
+
+#include <arpa/inet.h>
+#include <endian.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <cstring>
+
+#include "dsdisplay/Packet.hpp"
+{nested_includes(fields, nested_types)}
+namespace frc3512 {{
+
+struct {type_name} {{
+"""
+        )
+        for field in fields:
+            output.write(f"    {cpp_type(field)} {field.name}{default_value(field)};\n")
+        output.write(
+            f"""}};
+
+#pragma pack(push, 1)
+{wire_struct(f"{type_name}Wire", fields)}
+#pragma pack(pop)
+
+static_assert(sizeof({type_name}Wire) == {wire_size(fields, nested_types)});
+
+inline void ToWire(const {type_name}& value, {type_name}Wire& wire) {{
+{to_wire_statements(fields, "value.", "wire.", "    ")}}}
+
+inline void FromWire(const {type_name}Wire& wire, {type_name}& value) {{
+{from_wire_statements(fields, "wire.", "value.", "    ")}}}
+
+inline Packet& operator<<(Packet& packet, const {type_name}& value) {{
+{stream_statements(fields, "<<", "value.", "    ")}    return packet;
+}}
+
+inline Packet& operator>>(Packet& packet, {type_name}& value) {{
+{stream_statements(fields, ">>", "value.", "    ")}    return packet;
+}}
+
+}}  // namespace frc3512
+"""
+        )
+    os.rename(
+        f"{type_name}.hpp", f"{output_dir}/include/communications/{type_name}.hpp"
+    )
 
 
-def write_msg_header(
-    output_dir, msg_name, member_var_types, constructor_arg_types, member_var_names
-):
+def write_msg_header(output_dir, msg_name, fields, nested_types, standalone):
     """Write message header file.
 
     Keyword arguments:
     output_dir -- output directory root for source
     msg_name -- name of message in camel case
-    member_var_types -- list of member variable types
-    constructor_arg_types -- list of function argument types
-    member_var_names -- list of member variable names
+    fields -- list of Fields
+    nested_types -- dictionary of nested type names to their Fields
+    standalone -- true if the message isn't part of PacketType
     """
+    if standalone:
+        packet_type_include = ""
+        id_decl = """    // Standalone packets have no PacketType, so nodes ignore them
+    int8_t ID = -1;
+"""
+    else:
+        packet_type_include = '#include "communications/PacketType.hpp"\n'
+        id_decl = f"""    int8_t ID = static_cast<int8_t>(PacketType::k{msg_name});
+"""
+
     with open(f"{msg_name}Packet.hpp", "w") as output:
         output.write(
-            """#pragma once
+            f"""#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
 
+#include <array>
 #include <string>
 #include <string_view>
 
-#include "communications/PacketType.hpp"
-#include "dsdisplay/Packet.hpp"
+{packet_type_include}#include "communications/Topic.hpp"
+{nested_includes(fields, nested_types)}#include "dsdisplay/Packet.hpp"
+#include "dsdisplay/PacketReader.hpp"
 
-namespace frc3512 {
+namespace frc3512 {{
 
 """
         )
         output.write(f"class {msg_name}Packet {{\n")
         output.write("public:\n")
-        output.write(f"    int8_t ID = static_cast<int8_t>(PacketType::k{msg_name});\n")
-
-        default_vals = {"double": " = 0.0;\n", "int": " = 0;\n", "bool": " = false;\n"}
-        for i in range(len(member_var_types)):
-            output.write(f"    {member_var_types[i]} {member_var_names[i]}")
-            try:
-                output.write(default_vals[member_var_types[i]])
-            except KeyError:
-                # No known default value, so use default constructor instead
-                output.write(";\n")
+        if is_pod(fields, nested_types):
+            output.write(
+                f"""    /**
+     * Size of the serialized packet in bytes. Every field has a fixed size,
+     * so it's the same for every packet.
+     */
+    static constexpr size_t kWireSize = {wire_size(HEADER_FIELDS + fields, nested_types)};
+
+"""
+            )
+        output.write(id_decl)
+        output.write(
+            """
+    // Fully qualified topic name. Publish() points it at the name interned in
+    // TopicRegistry, so it stays valid for the rest of the program.
+    std::string_view topic;
+
+    // ID of the fully qualified topic name. Only the ID is serialized.
+    TopicID topicID = 0;
+
+    // When the packet was published, from NodeStats::Now()
+    int64_t sendTime = 0;
+
+"""
+        )
+
+        for field in fields:
+            output.write(
+                f"    {cpp_type(field)} {field.name}{default_value(field)};\n"
+            )
+        if is_pod(fields, nested_types):
+            wire_size_decl = """    /**
+     * Returns the size of the serialized packet in bytes.
+     */
+    constexpr size_t WireSize() const { return kWireSize; }
+"""
+        else:
+            wire_size_decl = """    /**
+     * Returns the size of the serialized packet in bytes.
+     */
+    size_t WireSize() const;
+"""
         output.write(
             f"""
     {msg_name}Packet() = default;
@@ -56,10 +424,8 @@ namespace frc3512 {
         )
         output.write(
             ", ".join(
-                [
-                    x[0] + " " + x[1]
-                    for x in zip(constructor_arg_types, member_var_names)
-                ]
+                ["std::string_view topic"]
+                + [f"{constructor_arg_type(x)} {x.name}" for x in fields]
             )
         )
         output.write(
@@ -72,6 +438,7 @@ namespace frc3512 {
      */
     {msg_name}Packet(Packet& packet);
 
+{wire_size_decl}
     /**
      * Serializes the given packet.
      *
@@ -80,6 +447,24 @@ namespace frc3512 {
      */
     Packet Serialize() const;
 
+    /**
+     * Serializes the packet like Serialize(), but spills into the given arena
+     * instead of the heap if it's larger than Packet::kInlineSize.
+     *
+     * @param arena The arena. The returned Packet must not be used after it's
+     *              reset.
+     */
+    Packet Serialize(PacketArena& arena) const;
+
+    /**
+     * Serializes the packet into the given buffer without allocating.
+     *
+     * @param buf  The buffer to write.
+     * @param size The size of the buffer. Should be at least WireSize().
+     * @return The number of bytes written, or 0 if the buffer was too small.
+     */
+    size_t Serialize(char* buf, size_t size) const;
+
     /**
      * Deserializes the given packet.
      *
@@ -94,6 +479,14 @@ namespace frc3512 {
      * @param packet The packet to deserialize.
      */
     void Deserialize(Packet& packet);
+
+    /**
+     * Deserializes the packet at the reader's position and advances the
+     * reader past it.
+     *
+     * @param reader The reader. Becomes invalid if the packet is cut off.
+     */
+    void Deserialize(PacketReader& reader);
 }};
 
 }}"""
@@ -104,37 +497,161 @@ namespace frc3512 {
     )
 
 
-def write_msg_source(
-    output_dir, msg_name, constructor_arg_types, member_var_names, serial_names
-):
+def wire_blocks(fields):
+    """Splits a message's fields into the blocks they're serialized as.
+
+    Runs of fixed-size fields form one block, which is copied through a
+    packed struct. Each string field is a block of its own. The packet
+    header is part of the first block.
+
+    Returns a list of (struct name or None, list of Fields) tuples.
+
+    Keyword arguments:
+    fields -- list of Fields
+    """
+    blocks = [list(HEADER_FIELDS)]
+    for field in fields:
+        if field.type == "string":
+            blocks.append([field])
+        elif blocks[-1][0].type == "string":
+            blocks.append([field])
+        else:
+            blocks[-1].append(field)
+
+    result = []
+    for block in blocks:
+        if block[0].type == "string":
+            result.append((None, block))
+        else:
+            result.append((f"Wire{len(result)}", block))
+    return result
+
+
+def read_block_statements(type, var, indent):
+    """Returns statements reading a struct from the PacketReader, or returning
+    if the buffer is too short.
+    """
+    return f"""{indent}{type} {var};
+{indent}if (!reader.ReadRaw({var})) {{
+{indent}    return;
+{indent}}}
+"""
+
+
+def write_msg_source(output_dir, msg_name, fields, nested_types):
     """Write message source file.
 
+    Runs of fixed-size fields are serialized through packed structs with the
+    wire layout, so they're copied in one block instead of field by field.
+    Serialize() writes straight into its destination and Deserialize() reads
+    straight from the caller's buffer.
+
     Keyword arguments:
     output_dir -- output directory root for source
     msg_name -- name of message in camel case
-    constructor_arg_types -- list of function argument types
-    member_var_names -- list of member variable names
-    serial_names -- list of member variable names to serialize/deserialize
+    fields -- list of Fields
+    nested_types -- dictionary of nested type names to their Fields
     """
+    blocks = wire_blocks(fields)
+    pod = is_pod(fields, nested_types)
     with open(f"{msg_name}Packet.cpp", "w") as output:
         output.write(
             f"""#include "communications/{msg_name}Packet.hpp"
 
+#include <arpa/inet.h>
+#include <endian.h>
+
+#include <cstring>
+
 using namespace frc3512;
 
+namespace {{
+
+#pragma pack(push, 1)
 """
         )
+        output.write(
+            "\n".join(
+                [wire_struct(name, block) for name, block in blocks if name]
+            )
+        )
+        output.write("\n#pragma pack(pop)\n")
+        if pod:
+            output.write(
+                f"""
+static_assert(sizeof(Wire0) == {msg_name}Packet::kWireSize);
+"""
+            )
+        output.write(
+            f"""
+/**
+ * Passes each block of the packet's serialized form to the given function
+ * in order.
+ *
+ * @param packet The packet.
+ * @param write  Function taking a const void* and a length in bytes.
+ */
+template <class F>
+void WriteBlocks(const {msg_name}Packet& packet, F&& write) {{
+"""
+        )
+        for i, (name, block) in enumerate(blocks):
+            if i > 0:
+                output.write("\n")
+            if name:
+                var = name.lower()
+                output.write(f"    {name} {var};\n")
+                output.write(
+                    to_wire_statements(block, "packet.", f"{var}.", "    ")
+                )
+                output.write(f"    write(&{var}, sizeof({var}));\n")
+            else:
+                field = block[0]
+                indent = "    "
+                value = f"packet.{field.name}"
+                if field.count is not None:
+                    output.write(f"    for (const auto& element : {value}) {{\n")
+                    indent = "        "
+                    value = "element"
+                output.write(
+                    f"""{indent}uint32_t {field.name}Length =
+{indent}    htonl(static_cast<uint32_t>({value}.size()));
+{indent}write(&{field.name}Length, sizeof({field.name}Length));
+{indent}write({value}.data(), {value}.size());
+"""
+                )
+                if field.count is not None:
+                    output.write("    }\n")
+        output.write(
+            f"""}}
+
+/**
+ * Appends the packet's serialized form to the given Packet.
+ *
+ * @param packet The packet.
+ * @param out    The Packet to append to.
+ */
+void AppendTo(const {msg_name}Packet& packet, Packet& out) {{
+    out.reserve(out.getDataSize() + packet.WireSize());
+    WriteBlocks(packet, [&](const void* data, size_t length) {{
+        out.append(data, length);
+    }});
+}}
+
+}}  // namespace
+
+"""
+        )
+
         output.write(f"{msg_name}Packet::{msg_name}Packet(")
         output.write(
             ", ".join(
-                [
-                    x[0] + " " + x[1]
-                    for x in zip(constructor_arg_types, member_var_names)
-                ]
+                ["std::string_view topic"]
+                + [f"{constructor_arg_type(x)} {x.name}" for x in fields]
             )
         )
         output.write(") {\n")
-        for name in member_var_names:
+        for name in ["topic"] + [x.name for x in fields]:
             output.write(f"    this->{name} = {name};\n")
         output.write(
             f"""}}
@@ -142,42 +659,236 @@ using namespace frc3512;
 {msg_name}Packet::{msg_name}Packet(Packet& packet) {{
     Deserialize(packet);
 }}
-
-Packet {msg_name}Packet::Serialize() const {{
-    Packet packet;
 """
         )
-        for name in serial_names:
-            output.write(f"    packet << {name};\n")
+
+        if not pod:
+            output.write(
+                f"""
+size_t {msg_name}Packet::WireSize() const {{
+    size_t size = 0;
+"""
+            )
+            for name, block in blocks:
+                if name:
+                    output.write(f"    size += sizeof({name});\n")
+                elif block[0].count is not None:
+                    output.write(
+                        f"""    for (const auto& element : {block[0].name}) {{
+        size += sizeof(uint32_t) + element.size();
+    }}
+"""
+                    )
+                else:
+                    output.write(
+                        f"    size += sizeof(uint32_t) + {block[0].name}.size();\n"
+                    )
+            output.write("    return size;\n}\n")
+
         output.write(
-            f"""    return packet;
+            f"""
+Packet {msg_name}Packet::Serialize() const {{
+    Packet packet;
+    AppendTo(*this, packet);
+    return packet;
+}}
+
+Packet {msg_name}Packet::Serialize(PacketArena& arena) const {{
+    Packet packet{{arena}};
+    AppendTo(*this, packet);
+    return packet;
+}}
+
+size_t {msg_name}Packet::Serialize(char* buf, size_t size) const {{
+    size_t wireSize = WireSize();
+    if (size < wireSize) {{
+        return 0;
+    }}
+
+    WriteBlocks(*this, [&](const void* data, size_t length) {{
+        std::memcpy(buf, data, length);
+        buf += length;
+    }});
+    return wireSize;
 }}
 
 void {msg_name}Packet::Deserialize(Packet& packet) {{
+    PacketReader reader{{packet}};
+    Deserialize(reader);
+}}
+
+void {msg_name}Packet::Deserialize(const char* buf, size_t length) {{
+    PacketReader reader{{buf, length}};
+    Deserialize(reader);
+}}
+
+void {msg_name}Packet::Deserialize(PacketReader& reader) {{"""
+        )
+        for i, (name, block) in enumerate(blocks):
+            output.write("\n")
+            if name:
+                var = name.lower()
+                output.write(read_block_statements(name, var, "    "))
+                output.write(from_wire_statements(block, f"{var}.", "", "    "))
+            else:
+                field = block[0]
+                indent = "    "
+                target = field.name
+                if field.count is not None:
+                    output.write(f"    for (auto& element : {field.name}) {{\n")
+                    indent = "        "
+                    target = "element"
+                view = f"{field.name}View"
+                output.write(
+                    f"""{indent}std::string_view {view};
+{indent}if (!(reader >> {view})) {{
+{indent}    return;
+{indent}}}
+{indent}{target}.assign({view});
 """
+                )
+                if field.count is not None:
+                    output.write("    }\n")
+        output.write(
+            """
+    topic = TopicRegistry::GetInstance().GetName(topicID);
+}"""
         )
-        for name in serial_names:
-            output.write(f"    packet >> {name};\n")
+    os.rename(
+        f"{msg_name}Packet.cpp", f"{output_dir}/cpp/communications/{msg_name}Packet.cpp"
+    )
+
+
+def write_msg_bench(output_dir, msg_name):
+    """Write message benchmark source file.
+
+    The benchmark measures Serialize(), Deserialize(), and delivery of the
+    message from one PublishNode to another. It's built into the bench
+    target alongside src/bench.
+
+    Keyword arguments:
+    output_dir -- output directory root for source
+    msg_name -- packet message name
+    """
+    with open(f"{msg_name}PacketBench.cpp", "w") as output:
         output.write(
-            f"""}}
+            f"""#include <atomic>
+#include <thread>
+#include <vector>
 
-void {msg_name}Packet::Deserialize(const char* buf, size_t length) {{
-    Packet packet;
-    packet.append(buf, length);
-    Deserialize(packet);
-}}"""
+#include "Benchmark.hpp"
+#include "communications/PublishNode.hpp"
+
+using namespace frc3512;
+using namespace frc3512::bench;
+
+namespace {{
+
+constexpr int kMessages = 1000000;
+constexpr int kRoundTrips = 100000;
+
+/**
+ * Counts {msg_name}Packets and otherwise does nothing with them.
+ */
+class {msg_name}SinkNode : public PublishNode {{
+public:
+    {msg_name}SinkNode() : PublishNode("{msg_name}Sink") {{}}
+
+    void ProcessMessage(const {msg_name}Packet& message) override {{
+        count.fetch_add(1, std::memory_order_release);
+    }}
+
+    std::atomic<int> count{{0}};
+}};
+
+}}  // namespace
+
+BENCHMARK({msg_name}Message) {{
+    {msg_name}Packet message;
+    auto serialized = message.Serialize();
+    std::vector<char> buf(message.WireSize());
+
+    int64_t startTime = NowNs();
+    for (int i = 0; i < kMessages; ++i) {{
+        auto packet = message.Serialize();
+        DoNotOptimize(packet);
+    }}
+    Report("Serialize/{msg_name}", kMessages, NowNs() - startTime);
+
+    startTime = NowNs();
+    for (int i = 0; i < kMessages; ++i) {{
+        message.Serialize(buf.data(), buf.size());
+        DoNotOptimize(buf.data());
+    }}
+    Report("SerializeIntoBuffer/{msg_name}", kMessages, NowNs() - startTime);
+
+    auto data = static_cast<const char*>(serialized.getData());
+    size_t size = serialized.getDataSize();
+    {msg_name}Packet received;
+    startTime = NowNs();
+    for (int i = 0; i < kMessages; ++i) {{
+        received.Deserialize(data, size);
+        DoNotOptimize(received);
+    }}
+    Report("Deserialize/{msg_name}", kMessages, NowNs() - startTime);
+
+    // Publishes one message at a time and waits for the subscriber to process
+    // it, so each sample is the full latency of a delivery
+    {msg_name}SinkNode publisher;
+    {msg_name}SinkNode subscriber;
+    subscriber.Subscribe(publisher);
+
+    LatencyStats latency{{kRoundTrips}};
+    startTime = NowNs();
+    for (int i = 0; i < kRoundTrips; ++i) {{
+        int64_t publishStart = NowNs();
+        publisher.Publish(message);
+        while (subscriber.count.load(std::memory_order_acquire) <= i) {{
+            std::this_thread::yield();
+        }}
+        latency.Add(NowNs() - publishStart);
+    }}
+    Report("RoundTrip/{msg_name}", kRoundTrips, NowNs() - startTime, latency);
+}}
+"""
         )
     os.rename(
-        f"{msg_name}Packet.cpp", f"{output_dir}/cpp/communications/{msg_name}Packet.cpp"
+        f"{msg_name}PacketBench.cpp",
+        f"{output_dir}/bench/communications/{msg_name}PacketBench.cpp",
     )
 
 
-def write_packettype_header(output_dir, msg_names):
+def schema_hash(msgs, nested_types):
+    """Returns the 32-bit FNV-1a hash of every message's and nested type's
+    fields, which changes whenever the serialized format does.
+
+    Keyword arguments:
+    msgs -- dictionary of packet message names to their Fields
+    nested_types -- dictionary of nested type names to their Fields
+    """
+    description = ""
+    for field in HEADER_FIELDS:
+        description += f"header {field.type} {field.name}\n"
+    for kind, types in [("msg", msgs), ("type", nested_types)]:
+        for name in sorted(types):
+            description += f"{kind} {name}\n"
+            for field in types[name]:
+                count = f"[{field.count}]" if field.count is not None else ""
+                description += f"{field.type}{count} {field.name}\n"
+
+    value = 0x811C9DC5
+    for byte in description.encode():
+        value = ((value ^ byte) * 0x01000193) & 0xFFFFFFFF
+    return value
+
+
+def write_packettype_header(output_dir, msg_names, hash):
     """Write PacketType.hpp header file.
 
     Keyword arguments:
     output_dir -- output directory root for source
     msg_names -- list of packet message names
+    hash -- the schema hash
     """
     with open("PacketType.hpp", "w") as output:
         output.write(
@@ -200,6 +911,24 @@ namespace frc3512 {
         else:
             multiline_types = ",".join(["\n    " + x for x in types])
             output.write(f"{enum_type} {{{multiline_types}\n}};\n")
+
+        # Names for logs and statistics, indexed by PacketType
+        names = ",".join([f'\n    "{x}"' for x in msg_names])
+        output.write(
+            f"""
+/**
+ * The name of each packet type, indexed by PacketType.
+ */
+constexpr const char* kPacketTypeNames[] = {{{names}}};
+
+/**
+ * Hash of every message's field types and names. Recordings and shared-memory
+ * rings store it so programs built from different messages don't misread
+ * each other's packets.
+ */
+constexpr uint32_t kSchemaHash = 0x{hash:08X};
+"""
+        )
         output.write(
             """
 }  // namespace frc3512
@@ -208,19 +937,18 @@ namespace frc3512 {
     os.rename("PacketType.hpp", f"{output_dir}/include/communications/PacketType.hpp")
 
 
-def write_publishnodebase_header(output_dir, msg_names):
-    """Write PublishNodeBase.hpp header file.
+def write_message_header(output_dir, msg_names):
+    """Write Message.hpp header file.
 
     Keyword arguments:
     output_dir -- output directory root for source
     msg_names -- list of packet message names
     """
-    with open("PublishNodeBase.hpp", "w") as output:
+    with open("Message.hpp", "w") as output:
         output.write(
             """#pragma once
 
-#include <wpi/SmallVector.h>
-#include <wpi/mutex.h>
+#include <variant>
 
 """
         )
@@ -230,18 +958,65 @@ def write_publishnodebase_header(output_dir, msg_names):
             """
 namespace frc3512 {
 
+/**
+ * Holds any packet type. The alternatives are in PacketType order, so
+ * index() is the packet's PacketType.
+ */
+using Message = std::variant<"""
+        )
+        output.write(", ".join([f"{x}Packet" for x in msg_names]))
+        output.write(
+            """>;
+
+}  // namespace frc3512
+"""
+        )
+    os.rename("Message.hpp", f"{output_dir}/include/communications/Message.hpp")
+
+
+def write_publishnodebase_header(output_dir, msg_names):
+    """Write PublishNodeBase.hpp header file.
+
+    Keyword arguments:
+    output_dir -- output directory root for source
+    msg_names -- list of packet message names
+    """
+    with open("PublishNodeBase.hpp", "w") as output:
+        output.write(
+            """#pragma once
+
+#include <stddef.h>
+
+#include "communications/Message.hpp"
+
+namespace frc3512 {
+
 class PublishNodeBase {
 public:
+    /**
+     * Process the provided message via the ProcessMessage() function
+     * corresponding to the type it holds.
+     *
+     * Do NOT provide an implementation for this function. generate_messages.py
+     * generates one in PublishNodeBase.cpp.
+     *
+     * @param message The message to process.
+     */
+    void DispatchMessage(const Message& message);
+
     /**
      * Deserialize the provided message and process it via the ProcessMessage()
      * function corresponding to the message type.
      *
+     * Empty messages and messages with an unknown packet type are ignored.
+     *
      * Do NOT provide an implementation for this function. generate_messages.py
      * generates one in PublishNodeBase.cpp.
      *
      * @param message The buffer containing the message to deserialize.
+     * @param length  The length of the message.
      */
-    void DeserializeAndProcessMessage(wpi::SmallVectorImpl<char>& message);
+    void DeserializeAndProcessMessage(const char* message, size_t length);
 
 """
         )
@@ -250,10 +1025,7 @@ public:
                 f"    virtual void ProcessMessage(const {msg_name}Packet& message) {{}}\n"
             )
         output.write(
-            """
-protected:
-    wpi::mutex m_mutex;
-};
+            """};
 
 }  // namespace frc3512
 """
@@ -275,28 +1047,67 @@ def write_publishnodebase_source(output_dir, msg_names):
         output.write(
             """#include "communications/PublishNodeBase.hpp"
 
-void frc3512::PublishNodeBase::DeserializeAndProcessMessage(wpi::SmallVectorImpl<char>& message) {
-    // Checks the first byte of the message for its ID to determine
-    // which packet to deserialize to, then processes it
-    auto packetType = static_cast<PacketType>(message[0]);
+#include <stdint.h>
+
+#include <iterator>
+#include <variant>
+
+using namespace frc3512;
+
+namespace {
+
+using Handler = void (*)(PublishNodeBase&, const char*, size_t);
+
+template <class P>
+void DeserializeAndProcess(PublishNodeBase& node, const char* message,
+                           size_t length) {
+    P packet;
+    packet.Deserialize(message, length);
+    node.ProcessMessage(packet);
+}
+
+// Deserializes and processes each packet type, indexed by PacketType
+constexpr Handler kHandlers[] = {"""
+        )
+        output.write(
+            ",".join(
+                [f"\n    &DeserializeAndProcess<{x}Packet>" for x in msg_names]
+            )
+        )
+        output.write(
+            """};
+
+static_assert(std::size(kHandlers) == std::variant_size_v<Message>,
+              "Every packet type needs a handler");
+static_assert(std::size(kHandlers) <= INT8_MAX + 1,
+              "PacketType must fit in the first byte of a packet");
 """
         )
         for i, msg_name in enumerate(msg_names):
-            if i == 0:
-                output.write("    if ")
-            else:
-                output.write(" else if ")
-            output.write(f"(packetType == PacketType::k{msg_name}) " "{\n")
-            output.write(f"        {msg_name}Packet packet;" "\n")
             output.write(
-                """        packet.Deserialize(message.data(), message.size());
-        m_mutex.unlock();
-        ProcessMessage(packet);
-        m_mutex.lock();
-    }"""
+                f"static_assert(static_cast<size_t>(PacketType::k{msg_name}) == {i});\n"
             )
         output.write(
             """
+}  // namespace
+
+void PublishNodeBase::DispatchMessage(const Message& message) {
+    std::visit([this](const auto& packet) { ProcessMessage(packet); }, message);
+}
+
+void PublishNodeBase::DeserializeAndProcessMessage(const char* message,
+                                                   size_t length) {
+    // The first byte of the message is its PacketType. Unknown types are
+    // dropped.
+    if (length == 0) {
+        return;
+    }
+    auto packetType = static_cast<uint8_t>(message[0]);
+    if (packetType >= std::size(kHandlers)) {
+        return;
+    }
+
+    kHandlers[packetType](*this, message, length);
 }
 """
         )
@@ -311,6 +1122,11 @@ def main():
     )
     parser.add_argument("--input", help="directory containing message files")
     parser.add_argument("--output", help="directory to which to write C++ source")
+    parser.add_argument(
+        "--standalone",
+        action="store_true",
+        help="generate only the packet classes, without PacketType, Message or PublishNodeBase, so tests can use messages the robot's nodes don't carry",
+    )
     args = parser.parse_args()
 
     msg_files = [
@@ -325,51 +1141,38 @@ def main():
         os.makedirs(f"{args.output}/cpp/communications")
     if not os.path.exists(f"{args.output}/include/communications"):
         os.makedirs(f"{args.output}/include/communications")
+    if not args.standalone and not os.path.exists(
+        f"{args.output}/bench/communications"
+    ):
+        os.makedirs(f"{args.output}/bench/communications")
 
-    # Parse schema files
-    var_regex = re.compile(r"(?P<type>\w+)\s+(?P<name>\w+)")
+    # Parse schema files. Files in a "types" directory declare types which
+    # can be nested in messages rather than messages of their own.
+    msgs = {}
+    nested_types = {}
     for filename in msg_files:
-        with open(filename, "r") as msgfile:
-            member_var_types = ["std::string"]
-            member_var_names = ["topic"]
-            constructor_arg_types = ["std::string_view"]
-            serial_names = ["ID", "topic"]
-            for line in msgfile:
-                # Strip comments
-                if line.find("#") != -1:
-                    line = line[: line.find("#")]
-
-                match = var_regex.search(line)
-                if match:
-                    type = match.group("type")
-                    name = match.group("name")
-                    if type == "string":
-                        member_var_types.append("std::string")
-                        constructor_arg_types.append("std::string_view")
-                    else:
-                        member_var_types.append(type)
-                        constructor_arg_types.append(type)
-                    member_var_names.append(name)
-                    serial_names.append(name)
-
-            msg_name = os.path.splitext(os.path.basename(filename))[0]
-            write_msg_header(
-                args.output,
-                msg_name,
-                member_var_types,
-                constructor_arg_types,
-                member_var_names,
-            )
-            write_msg_source(
-                args.output,
-                msg_name,
-                constructor_arg_types,
-                member_var_names,
-                serial_names,
-            )
-    msg_names = [os.path.splitext(os.path.basename(name))[0] for name in msg_files]
-    msg_names = sorted(msg_names)
-    write_packettype_header(args.output, msg_names)
+        name = os.path.splitext(os.path.basename(filename))[0]
+        if os.path.basename(os.path.dirname(filename)) == "types":
+            nested_types[name] = parse_msg_file(filename)
+        else:
+            msgs[name] = parse_msg_file(filename)
+
+    for type_name, fields in nested_types.items():
+        write_type_header(args.output, type_name, fields, nested_types)
+    for msg_name, fields in msgs.items():
+        write_msg_header(args.output, msg_name, fields, nested_types, args.standalone)
+        write_msg_source(args.output, msg_name, fields, nested_types)
+        if not args.standalone:
+            write_msg_bench(args.output, msg_name)
+
+    if args.standalone:
+        return
+
+    msg_names = sorted(msgs)
+    write_packettype_header(
+        args.output, msg_names, schema_hash(msgs, nested_types)
+    )
+    write_message_header(args.output, msg_names)
     write_publishnodebase_header(args.output, msg_names)
     write_publishnodebase_source(args.output, msg_names)
 
@@ -0,0 +1,88 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Benchmark.hpp"
+#include "communications/Blackboard.hpp"
+
+using namespace frc3512;
+using namespace frc3512::bench;
+
+namespace {
+
+constexpr int kReads = 1000000;
+
+/**
+ * How Climber cached status packets before the Blackboard: one copy behind a
+ * mutex.
+ */
+class MutexCache {
+public:
+    void Write(const ElevatorStatusPacket& p) {
+        std::lock_guard lock(m_mutex);
+        m_packet = p;
+    }
+
+    bool Read(TopicID topicID, ElevatorStatusPacket& p) {
+        std::lock_guard lock(m_mutex);
+        p = m_packet;
+        return true;
+    }
+
+private:
+    std::mutex m_mutex;
+    ElevatorStatusPacket m_packet;
+};
+
+/**
+ * Reads a status packet while another thread keeps publishing it, and reports
+ * the throughput and latency of both sides.
+ */
+template <class Cache>
+void RunReadBenchmark(std::string_view name, Cache& cache) {
+    ElevatorStatusPacket status{"", 0.5, 3.2, true, false};
+    status.topicID = "Elevator/Status"_topic;
+    cache.Write(status);
+
+    std::atomic<bool> isRunning{true};
+    LatencyStats writeLatency;
+    int64_t writes = 0;
+    std::thread writer([&, status]() mutable {
+        while (isRunning) {
+            status.distance += 0.001;
+            int64_t writeStart = NowNs();
+            cache.Write(status);
+            writeLatency.Add(NowNs() - writeStart);
+            ++writes;
+        }
+    });
+
+    LatencyStats latency{kReads};
+    int64_t startTime = NowNs();
+    ElevatorStatusPacket snapshot;
+    for (int i = 0; i < kReads; ++i) {
+        int64_t readStart = NowNs();
+        cache.Read("Elevator/Status"_topic, snapshot);
+        latency.Add(NowNs() - readStart);
+    }
+    int64_t totalTime = NowNs() - startTime;
+
+    isRunning = false;
+    writer.join();
+
+    Report(std::string{name} + "/Read", kReads, totalTime, latency);
+    Report(std::string{name} + "/Write", writes, totalTime, writeLatency);
+}
+
+}  // namespace
+
+BENCHMARK(StatusSnapshot) {
+    {
+        MutexCache cache;
+        RunReadBenchmark("StatusSnapshot/MutexCache", cache);
+    }
+    RunReadBenchmark("StatusSnapshot/Blackboard", Blackboard::GetInstance());
+}
@@ -0,0 +1,158 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <sys/resource.h>
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <wpi/condition_variable.h>
+#include <wpi/mutex.h>
+
+#include "Benchmark.hpp"
+#include "communications/PublishNode.hpp"
+
+using namespace frc3512;
+using namespace frc3512::bench;
+
+namespace {
+
+// Matches the number of nodes Robot::Robot() constructs
+constexpr int kNodes = 7;
+constexpr int kCycles = 5000;
+
+std::atomic<int> gProcessed{0};
+
+/**
+ * Counts the messages it processes on the shared executor.
+ */
+class ExecutorNode : public PublishNode {
+public:
+    explicit ExecutorNode(Executor& executor) : PublishNode("Node", executor) {}
+
+    void ProcessMessage(const HIDPacket& message) override { ++gProcessed; }
+};
+
+/**
+ * How PublishNode ran before it switched to a shared Executor: every node
+ * sleeps in a thread of its own until a message arrives.
+ */
+class ThreadPerNode : public PublishNodeBase {
+public:
+    ThreadPerNode() { m_thread = std::thread([this] { Run(); }); }
+
+    ~ThreadPerNode() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_isRunning = false;
+        }
+        m_ready.notify_all();
+        m_thread.join();
+    }
+
+    void PushMessage(const HIDPacket& p) {
+        m_queue.Emplace(std::in_place_type<HIDPacket>, p);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_isWaiting.load(std::memory_order_relaxed)) {
+            std::lock_guard lock(m_mutex);
+            m_ready.notify_one();
+        }
+    }
+
+    void ProcessMessage(const HIDPacket& message) override { ++gProcessed; }
+
+private:
+    LockFreeQueue<Message> m_queue{PublishNode::kNodeQueueSize};
+    std::thread m_thread;
+    std::atomic<bool> m_isRunning{true};
+    wpi::mutex m_mutex;
+    wpi::condition_variable m_ready;
+    std::atomic<bool> m_isWaiting{false};
+
+    void Run() {
+        while (m_isRunning) {
+            {
+                std::unique_lock lock(m_mutex);
+                m_isWaiting.store(true, std::memory_order_relaxed);
+                m_ready.wait(lock, [this] {
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    return !m_queue.Empty() || !m_isRunning;
+                });
+                m_isWaiting.store(false, std::memory_order_relaxed);
+            }
+
+            Message message;
+            while (m_queue.Pop(message)) {
+                DispatchMessage(message);
+            }
+        }
+    }
+};
+
+/**
+ * Returns the number of voluntary and involuntary context switches the process
+ * has made so far.
+ */
+int64_t ContextSwitches() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_nvcsw + usage.ru_nivcsw;
+}
+
+/**
+ * Wakes the given idle nodes with one HIDPacket each, as Robot does every
+ * cycle, and reports how long it takes until all of them processed it.
+ */
+template <class Node>
+void RunWakeupBenchmark(std::string_view name,
+                        std::vector<std::unique_ptr<Node>>& nodes) {
+    HIDPacket hid{"", {0.1, 0.3, 0.5, 0.7}, {0.2, 0.4, 0.6, 0.8}, {1, 2, 3, 4}};
+
+    LatencyStats latency{kCycles};
+    int64_t startSwitches = ContextSwitches();
+    int64_t startTime = NowNs();
+    for (int i = 0; i < kCycles; ++i) {
+        // Let every node go back to sleep between cycles
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+
+        gProcessed = 0;
+        int64_t cycleStart = NowNs();
+        for (auto& node : nodes) {
+            node->PushMessage(hid);
+        }
+        while (gProcessed < static_cast<int>(nodes.size())) {
+            std::this_thread::yield();
+        }
+        latency.Add(NowNs() - cycleStart);
+    }
+    int64_t totalTime = NowNs() - startTime;
+    int64_t switches = ContextSwitches() - startSwitches;
+
+    Report(name, kCycles, totalTime, latency);
+    std::printf("    %.1f context switches per cycle\n",
+                static_cast<double>(switches) / kCycles);
+}
+
+}  // namespace
+
+BENCHMARK(NodeWakeup) {
+    {
+        std::vector<std::unique_ptr<ThreadPerNode>> nodes;
+        for (int i = 0; i < kNodes; ++i) {
+            nodes.emplace_back(std::make_unique<ThreadPerNode>());
+        }
+        RunWakeupBenchmark("NodeWakeup/ThreadPerNode", nodes);
+    }
+    {
+        Executor executor{Executor::kDefaultNumWorkers,
+                          Executor::kDefaultPriority};
+        std::vector<std::unique_ptr<ExecutorNode>> nodes;
+        for (int i = 0; i < kNodes; ++i) {
+            nodes.emplace_back(std::make_unique<ExecutorNode>(executor));
+        }
+        RunWakeupBenchmark("NodeWakeup/SharedExecutor", nodes);
+    }
+}
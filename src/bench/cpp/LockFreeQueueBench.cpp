@@ -0,0 +1,100 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "communications/LockFreeQueue.hpp"
+#include "communications/Message.hpp"
+
+using namespace frc3512;
+using namespace frc3512::bench;
+
+namespace {
+
+constexpr int kProducers = 4;
+constexpr int kMessagesPerProducer = 200000;
+constexpr size_t kQueueSize = 64;
+constexpr size_t kBatchSize = 16;
+
+/**
+ * Pushes HIDPackets from several threads while one consumer drains the queue
+ * with the given function, and reports how long each push took including
+ * retries while the queue was full.
+ *
+ * @param drain Function taking the queue and a Message* arena of kBatchSize
+ *              elements, returning the number of messages it popped.
+ */
+template <class Drain>
+void RunContentionBenchmark(std::string_view name, Drain drain) {
+    LockFreeQueue<Message> queue{kQueueSize};
+    HIDPacket hid{"", {0.1, 0.3, 0.5, 0.7}, {0.2, 0.4, 0.6, 0.8}, {1, 2, 3, 4}};
+
+    std::atomic<bool> isRunning{true};
+    int64_t received = 0;
+    std::thread consumer([&] {
+        std::array<Message, kBatchSize> arena;
+        while (isRunning || !queue.Empty()) {
+            size_t count = drain(queue, arena.data());
+            if (count == 0) {
+                std::this_thread::yield();
+            }
+            received += count;
+        }
+    });
+
+    std::vector<LatencyStats> latencies;
+    for (int i = 0; i < kProducers; ++i) {
+        latencies.emplace_back(kMessagesPerProducer);
+    }
+
+    int64_t startTime = NowNs();
+    std::vector<std::thread> producers;
+    for (int i = 0; i < kProducers; ++i) {
+        producers.emplace_back([&, i] {
+            for (int j = 0; j < kMessagesPerProducer; ++j) {
+                int64_t pushStart = NowNs();
+                while (!queue.Emplace(hid)) {
+                    std::this_thread::yield();
+                }
+                latencies[i].Add(NowNs() - pushStart);
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    isRunning = false;
+    consumer.join();
+    int64_t totalTime = NowNs() - startTime;
+
+    LatencyStats latency;
+    for (auto& producerLatency : latencies) {
+        latency.Merge(producerLatency);
+    }
+    Report(name, kProducers * kMessagesPerProducer, totalTime, latency);
+    std::printf("    delivered %ld of %d\n", static_cast<long>(received),
+                kProducers * kMessagesPerProducer);
+}
+
+}  // namespace
+
+BENCHMARK(ProducerContention) {
+    RunContentionBenchmark(
+        "ProducerContention/PopEach",
+        [](LockFreeQueue<Message>& queue, Message* arena) {
+            size_t count = 0;
+            while (count < kBatchSize && queue.Pop(arena[count])) {
+                ++count;
+            }
+            return count;
+        });
+    RunContentionBenchmark(
+        "ProducerContention/PopBatch",
+        [](LockFreeQueue<Message>& queue, Message* arena) {
+            return queue.PopBatch(arena, kBatchSize);
+        });
+}
@@ -0,0 +1,25 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <cstdio>
+#include <string_view>
+
+#include "Benchmark.hpp"
+
+/**
+ * Runs every registered benchmark, or only those whose name contains the
+ * first command line argument.
+ */
+int main(int argc, char** argv) {
+    std::string_view filter;
+    if (argc > 1) {
+        filter = argv[1];
+    }
+
+    for (auto& benchmark : frc3512::bench::GetBenchmarks()) {
+        if (std::string_view{benchmark.name}.find(filter) !=
+            std::string_view::npos) {
+            std::printf("== %s\n", benchmark.name);
+            benchmark.func();
+        }
+    }
+}
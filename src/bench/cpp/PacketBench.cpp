@@ -0,0 +1,87 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <stdint.h>
+
+#include <array>
+#include <string>
+
+#include "Benchmark.hpp"
+#include "dsdisplay/Packet.hpp"
+
+using namespace frc3512;
+using namespace frc3512::bench;
+
+namespace {
+
+constexpr int kIterations = 1000000;
+
+/**
+ * Encodes and decodes an array one element at a time with operator<< and
+ * operator>>, then as one block with appendArray() and readArray(), and
+ * reports the time per array for each.
+ *
+ * Packet can't rewind its read position, so each decode starts from a copy
+ * of the encoded packet. Both decode rows include that copy.
+ */
+template <class T, size_t N>
+void RunArrayBenchmark(std::string_view name, const std::array<T, N>& array) {
+    Packet packet;
+    std::array<T, N> copy;
+
+    int64_t startTime = NowNs();
+    for (int i = 0; i < kIterations; ++i) {
+        packet.clear();
+        for (auto element : array) {
+            packet << element;
+        }
+        DoNotOptimize(packet.getData());
+    }
+    Report(std::string{name} + "/Elementwise/Encode", kIterations,
+           NowNs() - startTime);
+
+    startTime = NowNs();
+    for (int i = 0; i < kIterations; ++i) {
+        Packet encoded = packet;
+        for (auto& element : copy) {
+            encoded >> element;
+        }
+        DoNotOptimize(copy);
+    }
+    Report(std::string{name} + "/Elementwise/Decode", kIterations,
+           NowNs() - startTime);
+
+    startTime = NowNs();
+    for (int i = 0; i < kIterations; ++i) {
+        packet.clear();
+        packet.appendArray(array.data(), array.size());
+        DoNotOptimize(packet.getData());
+    }
+    Report(std::string{name} + "/Bulk/Encode", kIterations,
+           NowNs() - startTime);
+
+    startTime = NowNs();
+    for (int i = 0; i < kIterations; ++i) {
+        Packet encoded = packet;
+        encoded.readArray(copy.data(), copy.size());
+        DoNotOptimize(copy);
+    }
+    Report(std::string{name} + "/Bulk/Decode", kIterations,
+           NowNs() - startTime);
+}
+
+}  // namespace
+
+BENCHMARK(PacketArrays) {
+    // An EKF state and a covariance diagonal's worth of telemetry
+    std::array<double, 10> state{};
+    std::array<int32_t, 32> counts{};
+    for (size_t i = 0; i < state.size(); ++i) {
+        state[i] = 0.1 * i;
+    }
+    for (size_t i = 0; i < counts.size(); ++i) {
+        counts[i] = static_cast<int32_t>(i * 1000);
+    }
+
+    RunArrayBenchmark("PacketArrays/Double10", state);
+    RunArrayBenchmark("PacketArrays/Int32x32", counts);
+}
@@ -0,0 +1,107 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+#include "Benchmark.hpp"
+#include "communications/PublishNode.hpp"
+
+using namespace frc3512;
+using namespace frc3512::bench;
+
+namespace {
+
+constexpr int kCommands = 500;
+constexpr int64_t kCommandTimeoutNs = 20000000;
+
+// About what Drivetrain spends on a HIDPacket
+constexpr int64_t kHIDProcessingNs = 20000;
+
+std::atomic<int64_t> gCommandSentTime{0};
+std::atomic<int64_t> gCommandLatency{-1};
+
+/**
+ * Spends kHIDProcessingNs on each HIDPacket and records how long each command
+ * took to arrive.
+ */
+class LoadedNode : public PublishNode {
+public:
+    LoadedNode() : PublishNode("Loaded") {}
+
+    void ProcessMessage(const HIDPacket& message) override {
+        int64_t start = NowNs();
+        while (NowNs() - start < kHIDProcessingNs) {
+        }
+    }
+
+    void ProcessMessage(const CommandPacket& message) override {
+        gCommandLatency = NowNs() - gCommandSentTime;
+    }
+};
+
+/**
+ * Keeps the node's queue full of HIDPackets while sending it commands one at
+ * a time, and reports how long each command waited.
+ */
+void RunCommandLatencyBenchmark(std::string_view name,
+                                MessagePriority commandPriority) {
+    LoadedNode node;
+    node.SetPriority(PacketType::kCommand, commandPriority);
+
+    std::atomic<bool> isRunning{true};
+    std::thread telemetry([&] {
+        HIDPacket hid{
+            "", {0.1, 0.3, 0.5, 0.7}, {0.2, 0.4, 0.6, 0.8}, {1, 2, 3, 4}};
+        while (isRunning) {
+            // Bursts outpace the node, so its queue stays full
+            for (int i = 0; i < PublishNode::kNodeQueueSize; ++i) {
+                node.PushMessage(hid);
+            }
+            std::this_thread::yield();
+        }
+    });
+
+    // Let the backlog build up
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    LatencyStats latency{kCommands};
+    int lost = 0;
+    CommandPacket command{"DisabledInit", true, 0};
+    int64_t startTime = NowNs();
+    for (int i = 0; i < kCommands; ++i) {
+        gCommandLatency = -1;
+        gCommandSentTime = NowNs();
+        node.PushMessage(command);
+
+        // A command sharing the telemetry queue can be evicted from it
+        while (gCommandLatency < 0 &&
+               NowNs() - gCommandSentTime < kCommandTimeoutNs) {
+            std::this_thread::yield();
+        }
+        if (gCommandLatency < 0) {
+            ++lost;
+        } else {
+            latency.Add(gCommandLatency);
+        }
+    }
+    int64_t totalTime = NowNs() - startTime;
+
+    isRunning = false;
+    telemetry.join();
+
+    Report(name, kCommands, totalTime, latency);
+    std::printf("    %d of %d commands lost\n", lost, kCommands);
+    std::printf("    max queue depth: high %zu, normal %zu\n",
+                node.GetMaxQueueDepth(MessagePriority::kHigh),
+                node.GetMaxQueueDepth(MessagePriority::kNormal));
+}
+
+}  // namespace
+
+BENCHMARK(CommandLatencyUnderLoad) {
+    RunCommandLatencyBenchmark("CommandLatencyUnderLoad/SingleLane",
+                               MessagePriority::kNormal);
+    RunCommandLatencyBenchmark("CommandLatencyUnderLoad/PriorityLanes",
+                               MessagePriority::kHigh);
+}
@@ -0,0 +1,218 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <wpi/SmallVector.h>
+#include <wpi/circular_buffer.h>
+#include <wpi/condition_variable.h>
+#include <wpi/mutex.h>
+
+#include "Benchmark.hpp"
+#include "communications/PublishNode.hpp"
+#include "communications/Recorder.hpp"
+
+using namespace frc3512;
+using namespace frc3512::bench;
+
+namespace {
+
+constexpr int kProducers = 4;
+constexpr int kMessagesPerProducer = 200000;
+
+/**
+ * Counts messages and otherwise does nothing with them.
+ */
+class SinkNode : public PublishNode {
+public:
+    SinkNode() : PublishNode("Sink") {}
+
+    void ProcessMessage(const HIDPacket& message) override { ++count; }
+
+    std::atomic<int> count{0};
+};
+
+/**
+ * The queue PublishNode used before it switched to LockFreeQueue: every byte
+ * is pushed into a circular buffer under a mutex, then popped one at a time
+ * into a SmallVector by the consumer.
+ */
+class MutexByteQueueNode : public PublishNodeBase {
+public:
+    MutexByteQueueNode() { m_thread = std::thread([this] { Run(); }); }
+
+    ~MutexByteQueueNode() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_isRunning = false;
+        }
+        m_ready.notify_all();
+        m_thread.join();
+    }
+
+    template <class P>
+    void PushMessage(P p) {
+        Packet packet = p.Serialize();
+        size_t len = packet.getDataSize();
+        auto ptr = static_cast<const char*>(packet.getData());
+
+        std::lock_guard lock(m_mutex);
+        m_queue.push_back(len);
+        for (size_t j = 0; j < len; j++) {
+            m_queue.push_back(ptr[j]);
+        }
+        m_ready.notify_one();
+    }
+
+    void ProcessMessage(const HIDPacket& message) override { ++count; }
+
+    std::atomic<int> count{0};
+
+private:
+    wpi::mutex m_mutex;
+    wpi::condition_variable m_ready;
+    wpi::circular_buffer<char> m_queue{1024};
+    std::thread m_thread;
+    bool m_isRunning = true;
+
+    void Run() {
+        std::unique_lock lock(m_mutex);
+        while (m_isRunning) {
+            m_ready.wait(lock,
+                         [this] { return m_queue.size() > 0 || !m_isRunning; });
+            while (m_queue.size() > 0) {
+                size_t msgLength =
+                    static_cast<unsigned char>(m_queue.pop_front());
+                wpi::SmallVector<char, 32> message;
+                for (size_t i = 0; i < msgLength; i++) {
+                    message.push_back(m_queue.pop_front());
+                }
+                if (message.empty()) {
+                    // Overwritten bytes desynchronized the framing
+                    continue;
+                }
+                lock.unlock();
+                DeserializeAndProcessMessage(message.data(), message.size());
+                lock.lock();
+            }
+        }
+    }
+};
+
+/**
+ * Pushes HIDPackets into the given node from several threads and reports the
+ * enqueue throughput and latency.
+ */
+template <class Node>
+void RunPushBenchmark(std::string_view name, Node& node) {
+    HIDPacket message{
+        "Robot/", {0.1, 0.3, 0.5, 0.7}, {0.2, 0.4, 0.6, 0.8}, {1, 2, 3, 4}};
+
+    std::vector<LatencyStats> latencies;
+    for (int i = 0; i < kProducers; ++i) {
+        latencies.emplace_back(kMessagesPerProducer);
+    }
+
+    int64_t startTime = NowNs();
+    std::vector<std::thread> producers;
+    for (int i = 0; i < kProducers; ++i) {
+        producers.emplace_back([&, i] {
+            for (int j = 0; j < kMessagesPerProducer; ++j) {
+                int64_t pushStart = NowNs();
+                node.PushMessage(message);
+                latencies[i].Add(NowNs() - pushStart);
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    int64_t totalTime = NowNs() - startTime;
+
+    LatencyStats latency;
+    for (auto& producerLatency : latencies) {
+        latency.Merge(producerLatency);
+    }
+    Report(name, kProducers * kMessagesPerProducer, totalTime, latency);
+
+    // Let the consumer catch up so the delivered count is final
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    std::printf("    delivered %d of %d\n", node.count.load(),
+                kProducers * kMessagesPerProducer);
+}
+
+}  // namespace
+
+BENCHMARK(PushMessage) {
+    {
+        MutexByteQueueNode node;
+        RunPushBenchmark("PushMessage/MutexByteQueue", node);
+    }
+    {
+        SinkNode node;
+        RunPushBenchmark("PushMessage/LockFreeQueue", node);
+    }
+}
+
+BENCHMARK(PublishFanOut) {
+    // Matches the number of Robot subscribers set up in Robot::Robot()
+    constexpr int kSubscribers = 5;
+    constexpr int kMessages = 200000;
+
+    SinkNode publisher;
+    std::vector<std::unique_ptr<SinkNode>> subscribers;
+    for (int i = 0; i < kSubscribers; ++i) {
+        subscribers.emplace_back(std::make_unique<SinkNode>());
+        subscribers.back()->Subscribe(publisher);
+    }
+
+    HIDPacket message{
+        "", {0.1, 0.3, 0.5, 0.7}, {0.2, 0.4, 0.6, 0.8}, {1, 2, 3, 4}};
+
+    int64_t startTime = NowNs();
+    for (int i = 0; i < kMessages; ++i) {
+        publisher.Publish(message);
+    }
+    Report("Publish/FiveSubscribers", kMessages, NowNs() - startTime);
+
+    // Each publish records six messages: the publication and five deliveries.
+    // This loop records them far faster than the robot's traffic does, so the
+    // writer thread falls behind and the recorder drops most of them.
+    auto& recorder = Recorder::GetInstance();
+    recorder.Start("PublishFanOut.rec");
+    startTime = NowNs();
+    for (int i = 0; i < kMessages; ++i) {
+        publisher.Publish(message);
+    }
+    Report("Publish/FiveSubscribersRecording", kMessages, NowNs() - startTime);
+    recorder.Stop();
+    std::printf("    recorder dropped %lu of %d\n",
+                static_cast<unsigned long>(recorder.GetDropCount()),
+                kMessages * (kSubscribers + 1));
+    std::remove("PublishFanOut.rec");
+}
+
+BENCHMARK(DeserializeAndProcess) {
+    constexpr int kMessages = 1000000;
+
+    SinkNode node;
+
+    // The first and last packet types, which should cost the same to dispatch
+    auto runType = [&](std::string_view name, const Packet& packet) {
+        auto data = static_cast<const char*>(packet.getData());
+        size_t size = packet.getDataSize();
+
+        int64_t startTime = NowNs();
+        for (int i = 0; i < kMessages; ++i) {
+            node.DeserializeAndProcessMessage(data, size);
+        }
+        Report(name, kMessages, NowNs() - startTime);
+    };
+    runType("DeserializeAndProcess/Button",
+            ButtonPacket{"", 1, true}.Serialize());
+    runType("DeserializeAndProcess/State", StatePacket{"", 1.0}.Serialize());
+}
@@ -0,0 +1,136 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <atomic>
+#include <string_view>
+#include <thread>
+
+#include "Benchmark.hpp"
+#include "communications/PublishNode.hpp"
+
+using namespace frc3512;
+using namespace frc3512::bench;
+
+namespace {
+
+std::atomic<int> gProcessed{0};
+
+/**
+ * Stands in for a subsystem. Every message it receives is counted so the
+ * benchmark knows when a cycle's traffic has been fully processed.
+ */
+class TrafficNode : public PublishNode {
+public:
+    explicit TrafficNode(std::string_view name) : PublishNode(name) {}
+
+    void ProcessMessage(const ButtonPacket& message) override { ++gProcessed; }
+    void ProcessMessage(const CommandPacket& message) override {
+        ++gProcessed;
+    }
+    void ProcessMessage(const ElevatorStatusPacket& message) override {
+        ++gProcessed;
+    }
+    void ProcessMessage(const FourBarLiftStatusPacket& message) override {
+        ++gProcessed;
+    }
+    void ProcessMessage(const HIDPacket& message) override { ++gProcessed; }
+};
+
+
+/**
+ * Replays one 20 ms robot cycle's worth of traffic through the same node graph
+ * Robot::Robot() sets up, then waits for every subscriber to process it.
+ *
+ * Each cycle publishes a HIDPacket from Robot and status packets from Elevator
+ * and FourBarLift. Every tenth cycle adds a button event and a Climber
+ * command.
+ *
+ * @param name     Name to report the results under.
+ * @param filtered Whether to subscribe like Robot::Robot() does now rather
+ *                 than to every packet type.
+ */
+void RunTrafficMix(std::string_view name, bool filtered) {
+    constexpr int kCycles = 20000;
+
+    TrafficNode robot{"Robot"};
+    TrafficNode climber{"Climber"};
+    TrafficNode drivetrain{"Drivetrain"};
+    TrafficNode elevator{"Elevator"};
+    TrafficNode logger{"Logger"};
+    TrafficNode intake{"Intake"};
+    TrafficNode fourBarLift{"FourBarLift"};
+
+    auto subscribe = [&](TrafficNode& subscriber, TrafficNode& publisher,
+                         SubscriptionFilter filter) {
+        subscriber.Subscribe(publisher,
+                             filtered ? filter : SubscriptionFilter{});
+    };
+
+    SubscriptionFilter loggerFilter{PacketType::kButton, PacketType::kCommand,
+                                    PacketType::kState};
+    subscribe(logger, climber, loggerFilter);
+    subscribe(logger, drivetrain, loggerFilter);
+    subscribe(logger, elevator, loggerFilter);
+    subscribe(logger, intake, loggerFilter);
+    subscribe(logger, fourBarLift, loggerFilter);
+    subscribe(logger, robot, loggerFilter);
+    subscribe(climber, robot, {PacketType::kButton, PacketType::kCommand});
+    subscribe(climber, climber, {PacketType::kCommand});
+    if (!filtered) {
+        // Climber used to receive status packets before it read them from
+        // the Blackboard
+        climber.Subscribe(elevator);
+        climber.Subscribe(fourBarLift);
+    }
+    subscribe(drivetrain, robot,
+              {PacketType::kButton, PacketType::kCommand, PacketType::kHID});
+    subscribe(elevator, robot, {PacketType::kButton, PacketType::kCommand});
+    subscribe(elevator, climber, {PacketType::kCommand});
+    subscribe(elevator, fourBarLift, {PacketType::kCommand});
+    subscribe(intake, robot,
+              {{PacketType::kButton}, {"Robot/AppendageStick2"_topic}});
+    subscribe(fourBarLift, robot, {PacketType::kButton, PacketType::kCommand});
+    subscribe(fourBarLift, elevator, {PacketType::kCommand});
+    subscribe(fourBarLift, climber, {PacketType::kCommand});
+
+    HIDPacket hid{"", {0.1, 0.3, 0.5, 0.7}, {0.2, 0.4, 0.6, 0.8}, {1, 2, 3, 4}};
+    ElevatorStatusPacket elevatorStatus{"", 0.5, 3.2, true, false};
+    FourBarLiftStatusPacket fourBarLiftStatus{"", -0.7, 1.1, true, true};
+    ButtonPacket button{"AppendageStick2", 7, true};
+    CommandPacket command{"ThirdLevel", true, 0};
+
+    // Unfiltered, Robot has 6 subscribers, Elevator 3, FourBarLift 3 and
+    // Climber 4. Filtered, only Drivetrain takes the HIDPacket and nobody
+    // takes the status packets.
+    int perCycle = filtered ? 1 : 12;
+    int perTenthCycle = 10;
+
+    LatencyStats latency{kCycles};
+    int64_t startTime = NowNs();
+    for (int i = 0; i < kCycles; ++i) {
+        int64_t cycleStart = NowNs();
+        gProcessed = 0;
+
+        int expected = perCycle;
+        robot.Publish(hid);
+        elevator.Publish(elevatorStatus);
+        fourBarLift.Publish(fourBarLiftStatus);
+        if (i % 10 == 0) {
+            robot.Publish(button);
+            climber.Publish(command);
+            expected += perTenthCycle;
+        }
+
+        while (gProcessed < expected) {
+            std::this_thread::yield();
+        }
+        latency.Add(NowNs() - cycleStart);
+    }
+    Report(name, kCycles, NowNs() - startTime, latency);
+}
+
+}  // namespace
+
+BENCHMARK(RobotTrafficMix) {
+    RunTrafficMix("RobotTrafficMix/Cycle", false);
+    RunTrafficMix("RobotTrafficMix/FilteredCycle", true);
+}
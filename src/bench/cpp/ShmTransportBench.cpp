@@ -0,0 +1,73 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "Benchmark.hpp"
+#include "communications/ShmTransport.hpp"
+
+using namespace frc3512;
+using namespace frc3512::bench;
+
+namespace {
+
+constexpr int kWrites = 1000000;
+constexpr char kRingName[] = "/frc3512-bench";
+
+enum class ReaderMode { kNone, kStalled, kActive };
+
+/**
+ * Writes status packets into a ring and reports the write latency with the
+ * given kind of reader attached.
+ */
+void RunWriteBenchmark(std::string_view name, ReaderMode mode) {
+    ShmWriter writer{kRingName};
+    ShmReader reader{kRingName};
+
+    std::atomic<bool> isRunning{true};
+    int64_t received = 0;
+    std::thread readerThread;
+    if (mode == ReaderMode::kActive) {
+        readerThread = std::thread([&] {
+            while (isRunning) {
+                if (reader.Wait(std::chrono::milliseconds(10))) {
+                    while (reader.Read([](const Message&) {})) {
+                        ++received;
+                    }
+                }
+            }
+        });
+    }
+
+    ElevatorStatusPacket status{"Status", 0.5, 3.2, true, false};
+    LatencyStats latency{kWrites};
+    int64_t startTime = NowNs();
+    for (int i = 0; i < kWrites; ++i) {
+        int64_t writeStart = NowNs();
+        writer.Write(status);
+        latency.Add(NowNs() - writeStart);
+    }
+    int64_t totalTime = NowNs() - startTime;
+
+    isRunning = false;
+    if (readerThread.joinable()) {
+        readerThread.join();
+    }
+
+    Report(name, kWrites, totalTime, latency);
+    if (mode == ReaderMode::kActive) {
+        std::printf("    reader received %ld, lost %lu\n",
+                    static_cast<long>(received),
+                    static_cast<unsigned long>(reader.GetLostCount()));
+    }
+}
+
+}  // namespace
+
+BENCHMARK(ShmWrite) {
+    RunWriteBenchmark("ShmWrite/NoReader", ReaderMode::kNone);
+    RunWriteBenchmark("ShmWrite/StalledReader", ReaderMode::kStalled);
+    RunWriteBenchmark("ShmWrite/ActiveReader", ReaderMode::kActive);
+}
@@ -0,0 +1,108 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <stdint.h>
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "dsdisplay/Packet.hpp"
+#include "dsdisplay/PacketReader.hpp"
+#include "dsdisplay/TelemetryCodec.hpp"
+
+using namespace frc3512;
+using namespace frc3512::bench;
+
+namespace {
+
+constexpr int kFrames = 200000;
+
+// Fields per frame, like a drivetrain status packet's
+constexpr int kDoubles = 8;
+constexpr int kIntegers = 4;
+constexpr int kValues = kDoubles + kIntegers;
+
+/**
+ * Returns telemetry that changes slowly, like a mechanism moving smoothly
+ * with a few counters that tick up.
+ */
+std::vector<double> MakeDoubles() {
+    std::vector<double> values(kFrames * kDoubles);
+    for (int frame = 0; frame < kFrames; ++frame) {
+        double t = frame * 0.005;
+        for (int i = 0; i < kDoubles; ++i) {
+            // Half the fields hold still, like setpoints and limits
+            values[frame * kDoubles + i] =
+                i % 2 == 0 ? std::sin(t + i) : 12.0 * (i + 1);
+        }
+    }
+    return values;
+}
+
+std::vector<int64_t> MakeIntegers() {
+    std::vector<int64_t> values(kFrames * kIntegers);
+    for (int frame = 0; frame < kFrames; ++frame) {
+        for (int i = 0; i < kIntegers; ++i) {
+            values[frame * kIntegers + i] = frame * i;
+        }
+    }
+    return values;
+}
+
+}  // namespace
+
+BENCHMARK(TelemetryCodec) {
+    auto doubles = MakeDoubles();
+    auto integers = MakeIntegers();
+
+    // Frames are encoded into one packet per frame, as they'd be sent
+    std::vector<Packet> packets(kFrames);
+
+    TelemetryEncoder encoder;
+    int64_t startTime = NowNs();
+    for (int frame = 0; frame < kFrames; ++frame) {
+        auto& packet = packets[frame];
+        encoder.BeginFrame(packet);
+        for (int i = 0; i < kDoubles; ++i) {
+            encoder.EncodeDouble(packet, doubles[frame * kDoubles + i]);
+        }
+        for (int i = 0; i < kIntegers; ++i) {
+            encoder.EncodeInteger(packet, integers[frame * kIntegers + i]);
+        }
+    }
+    Report("TelemetryCodec/Encode/PerValue", kFrames * kValues,
+           NowNs() - startTime);
+
+    TelemetryDecoder decoder;
+    double d = 0.0;
+    int64_t n = 0;
+    startTime = NowNs();
+    for (int frame = 0; frame < kFrames; ++frame) {
+        PacketReader reader{packets[frame]};
+        decoder.BeginFrame(reader);
+        for (int i = 0; i < kDoubles; ++i) {
+            decoder.DecodeDouble(reader, d);
+        }
+        for (int i = 0; i < kIntegers; ++i) {
+            decoder.DecodeInteger(reader, n);
+        }
+        DoNotOptimize(d);
+        DoNotOptimize(n);
+    }
+    Report("TelemetryCodec/Decode/PerValue", kFrames * kValues,
+           NowNs() - startTime);
+
+    // Without the codec, doubles take 8 bytes and integers are sent as 4-byte
+    // ints
+    size_t encodedSize = 0;
+    for (const auto& packet : packets) {
+        encodedSize += packet.getDataSize();
+    }
+    size_t rawSize = kFrames * (kDoubles * sizeof(double) +
+                                kIntegers * sizeof(int32_t));
+    std::printf("    %.2f bytes per value, %.1f%% of raw\n",
+                static_cast<double>(encodedSize) / (kFrames * kValues),
+                100.0 * encodedSize / rawSize);
+}
@@ -0,0 +1,144 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+namespace frc3512::bench {
+
+/**
+ * Collects latency samples in nanoseconds and reports percentiles.
+ */
+class LatencyStats {
+public:
+    LatencyStats() = default;
+
+    /**
+     * Reserves space for samples so recording doesn't allocate.
+     */
+    explicit LatencyStats(size_t expectedSamples) {
+        m_samples.reserve(expectedSamples);
+    }
+
+    void Add(int64_t ns) { m_samples.push_back(ns); }
+
+    /**
+     * Appends another set of samples to this one.
+     */
+    void Merge(const LatencyStats& other) {
+        m_samples.insert(m_samples.end(), other.m_samples.begin(),
+                         other.m_samples.end());
+    }
+
+    size_t Count() const { return m_samples.size(); }
+
+    double Mean() const {
+        if (m_samples.empty()) {
+            return 0.0;
+        }
+        double sum = 0.0;
+        for (auto sample : m_samples) {
+            sum += sample;
+        }
+        return sum / m_samples.size();
+    }
+
+    /**
+     * Returns the given percentile of the samples.
+     *
+     * @param percentile Percentile on [0..100].
+     */
+    int64_t Percentile(double percentile) {
+        if (m_samples.empty()) {
+            return 0;
+        }
+        size_t index = static_cast<size_t>(percentile / 100.0 *
+                                           (m_samples.size() - 1));
+        std::nth_element(m_samples.begin(), m_samples.begin() + index,
+                         m_samples.end());
+        return m_samples[index];
+    }
+
+private:
+    std::vector<int64_t> m_samples;
+};
+
+/**
+ * Returns the current time of the monotonic clock in nanoseconds.
+ */
+inline int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * Keeps the compiler from optimizing away the computation of the given value
+ * when nothing else reads it.
+ */
+template <class T>
+inline void DoNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * Prints one row of benchmark results.
+ *
+ * @param name    Name of the benchmark.
+ * @param ops     Number of operations performed.
+ * @param totalNs Wall time the operations took in nanoseconds.
+ * @param latency Per-operation latency samples.
+ */
+inline void Report(std::string_view name, size_t ops, int64_t totalNs,
+                   LatencyStats& latency) {
+    double opsPerSec = ops / (totalNs / 1e9);
+    std::printf("%-48.*s %12.0f ops/s %10.1f ns mean %8ld ns p50 %8ld ns p99\n",
+                static_cast<int>(name.size()), name.data(), opsPerSec,
+                latency.Mean(), static_cast<long>(latency.Percentile(50.0)),
+                static_cast<long>(latency.Percentile(99.0)));
+}
+
+/**
+ * Prints one row of benchmark results for benchmarks without per-operation
+ * latency samples.
+ */
+inline void Report(std::string_view name, size_t ops, int64_t totalNs) {
+    double opsPerSec = ops / (totalNs / 1e9);
+    std::printf("%-48.*s %12.0f ops/s %10.1f ns/op\n",
+                static_cast<int>(name.size()), name.data(), opsPerSec,
+                static_cast<double>(totalNs) / ops);
+}
+
+using BenchmarkFunc = void (*)();
+
+struct BenchmarkEntry {
+    const char* name;
+    BenchmarkFunc func;
+};
+
+inline std::vector<BenchmarkEntry>& GetBenchmarks() {
+    static std::vector<BenchmarkEntry> benchmarks;
+    return benchmarks;
+}
+
+inline int RegisterBenchmark(const char* name, BenchmarkFunc func) {
+    GetBenchmarks().push_back({name, func});
+    return 0;
+}
+
+}  // namespace frc3512::bench
+
+/**
+ * Defines a benchmark function which Main.cpp runs.
+ */
+#define BENCHMARK(name)                                             \
+    static void name();                                             \
+    [[maybe_unused]] static int name##Registered =                  \
+        frc3512::bench::RegisterBenchmark(#name, name);             \
+    static void name()
@@ -2,55 +2,99 @@
 
 #include "Robot.hpp"
 
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <frc/Filesystem.h>
+#include <wpi/Path.h>
+#include <wpi/SmallString.h>
+#include <wpi/Twine.h>
 #include <wpi/raw_ostream.h>
 
 namespace frc3512 {
 
 Robot::Robot() : PublishNode("Robot") {
+    // Each subscription only accepts the packet types the subscriber has
+    // ProcessMessage() overrides for
+    SubscriptionFilter loggerFilter{PacketType::kButton, PacketType::kCommand,
+                                    PacketType::kState};
+
     m_logger.AddLogSink(fileSink);
-    m_logger.Subscribe(m_climber);
-    m_logger.Subscribe(m_drivetrain);
-    m_logger.Subscribe(m_elevator);
-    m_logger.Subscribe(m_intake);
-    m_logger.Subscribe(m_fourBarLift);
-    m_logger.Subscribe(*this);
-
-    m_climber.Subscribe(*this);
-    m_climber.Subscribe(m_climber);
-    m_climber.Subscribe(m_elevator);
-    m_climber.Subscribe(m_fourBarLift);
-    m_drivetrain.Subscribe(*this);
-    m_elevator.Subscribe(*this);
-    m_elevator.Subscribe(m_climber);
-    m_elevator.Subscribe(m_fourBarLift);
-    m_intake.Subscribe(*this);
-    m_fourBarLift.Subscribe(*this);
-    m_fourBarLift.Subscribe(m_elevator);
-    m_fourBarLift.Subscribe(m_climber);
+    m_logger.Subscribe(m_climber, loggerFilter);
+    m_logger.Subscribe(m_drivetrain, loggerFilter);
+    m_logger.Subscribe(m_elevator, loggerFilter);
+    m_logger.Subscribe(m_intake, loggerFilter);
+    m_logger.Subscribe(m_fourBarLift, loggerFilter);
+    m_logger.Subscribe(*this, loggerFilter);
+
+    m_climber.Subscribe(*this, {PacketType::kButton, PacketType::kCommand});
+    m_climber.Subscribe(m_climber, {PacketType::kCommand});
+    m_climber.Subscribe(m_elevator,
+                        {{PacketType::kCommand}, {"Elevator/Reply"_topic}});
+    m_climber.Subscribe(m_fourBarLift,
+                        {{PacketType::kCommand}, {"FourBarLift/Reply"_topic}});
+    m_drivetrain.Subscribe(*this, {PacketType::kButton, PacketType::kCommand,
+                                   PacketType::kHID});
+    m_elevator.Subscribe(*this, {PacketType::kButton, PacketType::kCommand});
+    m_elevator.Subscribe(m_climber, {PacketType::kCommand});
+    m_elevator.Subscribe(m_fourBarLift, {PacketType::kCommand});
+    m_intake.Subscribe(
+        *this, {{PacketType::kButton}, {"Robot/AppendageStick2"_topic}});
+    m_fourBarLift.Subscribe(*this, {PacketType::kButton, PacketType::kCommand});
+    m_fourBarLift.Subscribe(m_elevator, {PacketType::kCommand});
+    m_fourBarLift.Subscribe(m_climber, {PacketType::kCommand});
+
+    // Off-robot tools such as a simulator or dashboard bridge attach to this
+    // ring instead of subscribing, so they can't slow the nodes down
+    m_climber.PublishTo(m_telemetry);
+    m_drivetrain.PublishTo(m_telemetry);
+    m_elevator.PublishTo(m_telemetry);
+    m_intake.PublishTo(m_telemetry);
+    m_fourBarLift.PublishTo(m_telemetry);
+    PublishTo(m_telemetry);
+
+    // Joystick packets are republished every cycle, so if Drivetrain falls
+    // behind it should skip to the newest one instead of working through a
+    // backlog
+    m_drivetrain.SetOverflowPolicy(PacketType::kHID, OverflowPolicy::kLatest);
+
+    // Joystick input older than two robot loop periods no longer reflects
+    // what the driver is doing, so Drivetrain drops it
+    m_drivetrain.SetMaxAge(PacketType::kHID, std::chrono::milliseconds(40));
 
     camera.SetResolution(160, 120);
     camera.SetFPS(15);
     server.SetSource(camera);
 
-    m_fourBarLift.Subscribe(m_climber);
-
     frc::LiveWindow::GetInstance()->DisableAllTelemetry();
 }
 
 void Robot::DisabledInit() {
-    CommandPacket message{"DisabledInit", false};
+    CommandPacket message{"DisabledInit", false, 0};
     Publish(message);
+
+    // Covers the match period that just ended
+    ExportNodeStats();
+    Recorder::GetInstance().Stop();
 }
 
 void Robot::AutonomousInit() {
-    CommandPacket message{"AutonomousInit", false};
+    StartRecording();
+
+    CommandPacket message{"AutonomousInit", false, 0};
     Publish(message);
     m_drivetrain.SetWaypoints(
         {frc::Pose2d(0_m, 0_m, 0_rad), frc::Pose2d(4.8768_m, 2.7432_m, 0_rad)});
 }
 
 void Robot::TeleopInit() {
-    CommandPacket message{"TeleopInit", false};
+    StartRecording();
+
+    CommandPacket message{"TeleopInit", false, 0};
     Publish(message);
 
     for (int i = 1; i <= 12; i++) {
@@ -79,6 +123,70 @@ void Robot::TeleopInit() {
 
 void Robot::TestInit() {}
 
+void Robot::ExportNodeStats() {
+    std::array<const PublishNode*, 7> nodes{this,          &m_climber,
+                                            &m_drivetrain, &m_elevator,
+                                            &m_logger,     &m_intake,
+                                            &m_fourBarLift};
+
+    std::vector<NodeStatsSnapshot> snapshots;
+    for (auto node : nodes) {
+        snapshots.emplace_back(node->GetStats());
+    }
+
+    for (const auto& snapshot : snapshots) {
+        m_logger.LogNodeStats(snapshot);
+    }
+
+    wpi::SmallString<64> path;
+    frc::filesystem::GetOperatingDirectory(path);
+    wpi::sys::path::append(path, "NodeStats.csv");
+
+    std::ofstream file{wpi::Twine{path}.str()};
+    NodeStatsSnapshot::WriteCsvHeader(file);
+    for (const auto& snapshot : snapshots) {
+        snapshot.WriteCsv(file);
+    }
+
+    path.clear();
+    frc::filesystem::GetOperatingDirectory(path);
+    wpi::sys::path::append(path, "NodeEdges.csv");
+
+    std::ofstream edgeFile{wpi::Twine{path}.str()};
+    NodeStatsSnapshot::WriteEdgeCsvHeader(edgeFile);
+    for (const auto& snapshot : snapshots) {
+        snapshot.WriteEdgeCsv(edgeFile);
+    }
+}
+
+void Robot::StartRecording() {
+    // Autonomous and teleop of one match go in one recording. Rotating here
+    // would rename the file the Recorder is still writing.
+    auto& recorder = Recorder::GetInstance();
+    if (recorder.IsRecording()) {
+        return;
+    }
+
+    wpi::SmallString<64> directory;
+    frc::filesystem::GetOperatingDirectory(directory);
+    auto recordingPath = [&](int index) {
+        wpi::SmallString<64> path{directory};
+        wpi::sys::path::append(path,
+                               "Traffic-" + std::to_string(index) + ".rec");
+        return wpi::Twine{path}.str();
+    };
+
+    // Shift each recording up one index, deleting the oldest
+    std::remove(recordingPath(kMaxRecordings - 1).c_str());
+    for (int i = kMaxRecordings - 1; i > 0; --i) {
+        std::rename(recordingPath(i - 1).c_str(), recordingPath(i).c_str());
+    }
+
+    if (!recorder.Start(recordingPath(0))) {
+        wpi::errs() << "Robot: traffic isn't being recorded\n";
+    }
+}
+
 void Robot::RobotPeriodic() {}
 
 void Robot::DisabledPeriodic() {
@@ -123,19 +231,15 @@ void Robot::TeleopPeriodic() {
     }
 
     auto& ds = frc::DriverStation::GetInstance();
-    HIDPacket message{"",
-                      m_driveStick1.GetX(),
-                      m_driveStick1.GetY(),
-                      ds.GetStickButtons(0),
-                      m_driveStick2.GetX(),
-                      m_driveStick2.GetY(),
-                      ds.GetStickButtons(1),
-                      m_appendageStick.GetX(),
-                      m_appendageStick.GetY(),
-                      ds.GetStickButtons(2),
-                      m_appendageStick2.GetX(),
-                      m_appendageStick2.GetY(),
-                      ds.GetStickButtons(3)};
+    HIDPacket message{"HID",
+                      {m_driveStick1.GetX(), m_driveStick2.GetX(),
+                       m_appendageStick.GetX(), m_appendageStick2.GetX()},
+                      {m_driveStick1.GetY(), m_driveStick2.GetY(),
+                       m_appendageStick.GetY(), m_appendageStick2.GetY()},
+                      {static_cast<int32_t>(ds.GetStickButtons(0)),
+                       static_cast<int32_t>(ds.GetStickButtons(1)),
+                       static_cast<int32_t>(ds.GetStickButtons(2)),
+                       static_cast<int32_t>(ds.GetStickButtons(3))}};
     Publish(message);
 }
 
@@ -0,0 +1,43 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include "communications/Blackboard.hpp"
+
+using namespace frc3512;
+
+Blackboard& Blackboard::GetInstance() {
+    static Blackboard instance;
+    return instance;
+}
+
+Blackboard::Slot* Blackboard::ClaimSlot(TopicID topicID) {
+    for (size_t probe = 0; probe < kMaxTopics; ++probe) {
+        auto& slot = m_slots[(topicID + probe) % kMaxTopics];
+
+        TopicID current = slot.topicID.load(std::memory_order_acquire);
+        if (current == 0 &&
+            slot.topicID.compare_exchange_strong(current, topicID,
+                                                 std::memory_order_acq_rel)) {
+            return &slot;
+        }
+        if (current == topicID) {
+            return &slot;
+        }
+    }
+
+    return nullptr;
+}
+
+const Blackboard::Slot* Blackboard::FindSlot(TopicID topicID) const {
+    for (size_t probe = 0; probe < kMaxTopics; ++probe) {
+        auto& slot = m_slots[(topicID + probe) % kMaxTopics];
+
+        TopicID current = slot.topicID.load(std::memory_order_acquire);
+        if (current == 0) {
+            return nullptr;
+        } else if (current == topicID) {
+            return &slot;
+        }
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,79 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include "communications/DeadlineTimer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <mutex>
+
+#include "communications/NodeStats.hpp"
+
+using namespace frc3512;
+
+DeadlineTimer::DeadlineTimer() {
+    m_thread = std::thread([this] { Run(); });
+}
+
+DeadlineTimer::~DeadlineTimer() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_isRunning = false;
+    }
+    m_ready.notify_all();
+    m_thread.join();
+}
+
+DeadlineTimer& DeadlineTimer::GetInstance() {
+    static DeadlineTimer instance;
+    return instance;
+}
+
+void DeadlineTimer::Add(int64_t deadline, Strand& strand) {
+    bool isEarliest;
+    {
+        std::lock_guard lock(m_mutex);
+        m_entries.push_back({deadline, &strand});
+        std::push_heap(m_entries.begin(), m_entries.end(), std::greater<>{});
+        isEarliest = m_entries.front().strand == &strand &&
+                     m_entries.front().deadline == deadline;
+    }
+
+    // Only a new earliest deadline changes how long the thread should sleep
+    if (isEarliest) {
+        m_ready.notify_all();
+    }
+}
+
+void DeadlineTimer::Cancel(Strand& strand) {
+    std::lock_guard lock(m_mutex);
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(),
+                                   [&](const auto& entry) {
+                                       return entry.strand == &strand;
+                                   }),
+                    m_entries.end());
+    std::make_heap(m_entries.begin(), m_entries.end(), std::greater<>{});
+}
+
+void DeadlineTimer::Run() {
+    std::unique_lock lock(m_mutex);
+    while (m_isRunning) {
+        if (m_entries.empty()) {
+            m_ready.wait(lock);
+            continue;
+        }
+
+        int64_t now = NodeStats::Now();
+        if (m_entries.front().deadline > now) {
+            m_ready.wait_for(lock, std::chrono::nanoseconds{
+                                       m_entries.front().deadline - now});
+            continue;
+        }
+
+        // Notified under the lock so Cancel() can't return while the strand
+        // is being notified
+        std::pop_heap(m_entries.begin(), m_entries.end(), std::greater<>{});
+        m_entries.back().strand->Notify();
+        m_entries.pop_back();
+    }
+}
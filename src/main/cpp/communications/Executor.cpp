@@ -0,0 +1,129 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include "communications/Executor.hpp"
+
+#include <cstdlib>
+#include <mutex>
+
+#include <frc/Threads.h>
+#include <wpi/raw_ostream.h>
+
+using namespace frc3512;
+
+namespace {
+
+// Identifies the worker the current thread is, if any
+thread_local Executor* t_executor = nullptr;
+thread_local size_t t_workerIndex = 0;
+
+}  // namespace
+
+Executor::Executor(int numWorkers, int priority) {
+    for (int i = 0; i < numWorkers; ++i) {
+        m_workers.emplace_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        m_workers[i]->thread =
+            std::thread(&Executor::RunWorker, this, i, priority);
+    }
+}
+
+Executor::~Executor() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_isRunning = false;
+    }
+    m_ready.notify_all();
+    for (auto& worker : m_workers) {
+        worker->thread.join();
+    }
+}
+
+Executor& Executor::GetDefault() {
+    static Executor instance{kDefaultNumWorkers, kDefaultPriority};
+    return instance;
+}
+
+void Executor::Schedule(Strand& strand) {
+    size_t start;
+    if (t_executor == this) {
+        start = t_workerIndex;
+    } else {
+        start = m_nextWorker.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // AddStrand() keeps the strand count within one queue's capacity, so
+    // this always finds room
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        auto& worker = m_workers[(start + i) % m_workers.size()];
+        if (worker->queue.Emplace(&strand)) {
+            break;
+        }
+    }
+
+    // Pairs with the fence in RunWorker(). Either a sleeping worker sees the
+    // strand before it sleeps, or this thread sees m_numSleeping set and
+    // takes the mutex to wake it.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_numSleeping.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard lock(m_mutex);
+        m_ready.notify_one();
+    }
+}
+
+int Executor::NumWorkers() const { return m_workers.size(); }
+
+void Executor::AddStrand() {
+    if (m_numStrands.fetch_add(1, std::memory_order_relaxed) >= kMaxStrands) {
+        // A strand that doesn't fit in the queues would silently never run
+        wpi::errs() << "Executor: more than " << kMaxStrands
+                    << " strands constructed\n";
+        std::abort();
+    }
+}
+
+void Executor::RemoveStrand() {
+    m_numStrands.fetch_sub(1, std::memory_order_relaxed);
+}
+
+Strand* Executor::FindWork(size_t index) {
+    Strand* strand;
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        if (m_workers[(index + i) % m_workers.size()]->queue.Pop(strand)) {
+            return strand;
+        }
+    }
+    return nullptr;
+}
+
+bool Executor::HasWork() const {
+    for (auto& worker : m_workers) {
+        if (!worker->queue.Empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Executor::RunWorker(size_t index, int priority) {
+    t_executor = this;
+    t_workerIndex = index;
+    if (priority > 0) {
+        frc::SetCurrentThreadPriority(true, priority);
+    }
+
+    while (m_isRunning) {
+        if (Strand* strand = FindWork(index); strand != nullptr) {
+            strand->Run();
+            continue;
+        }
+
+        std::unique_lock lock(m_mutex);
+        m_numSleeping.fetch_add(1, std::memory_order_relaxed);
+        m_ready.wait(lock, [this] {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            return HasWork() || !m_isRunning;
+        });
+        m_numSleeping.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,209 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include "communications/NodeStats.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+using namespace frc3512;
+
+namespace {
+
+std::atomic<size_t> gNextShard{0};
+
+// Spreads threads across shards in the order they first record something
+thread_local size_t t_shard = gNextShard.fetch_add(1);
+
+void Add(std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+uint64_t Load(const std::atomic<uint64_t>& counter) {
+    return counter.load(std::memory_order_relaxed);
+}
+
+}  // namespace
+
+size_t Histogram::BucketOf(int64_t ns) {
+    if (ns <= 0) {
+        return 0;
+    }
+
+    size_t bucket = 64 - __builtin_clzll(static_cast<uint64_t>(ns));
+    return std::min(bucket, kNumBuckets - 1);
+}
+
+uint64_t Histogram::Count() const {
+    uint64_t count = 0;
+    for (auto bucket : buckets) {
+        count += bucket;
+    }
+    return count;
+}
+
+int64_t Histogram::Percentile(double percentile) const {
+    uint64_t count = Count();
+    if (count == 0) {
+        return 0;
+    }
+
+    auto rank = static_cast<uint64_t>(percentile / 100.0 * (count - 1));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+        seen += buckets[i];
+        if (seen > rank) {
+            return i == 0 ? 0 : int64_t{1} << i;
+        }
+    }
+    return int64_t{1} << (kNumBuckets - 1);
+}
+
+std::string NodeStatsSnapshot::ToString() const {
+    std::ostringstream os;
+    os << nodeName << ": queue depth high " << queueDepth[0] << " (max "
+       << maxQueueDepth[0] << "), normal " << queueDepth[1] << " (max "
+       << maxQueueDepth[1] << ")\n";
+
+    for (size_t i = 0; i < types.size(); ++i) {
+        auto& type = types[i];
+        if (type.published == 0 && type.received == 0 && type.dropped == 0) {
+            continue;
+        }
+
+        os << "  " << kPacketTypeNames[i] << ": published " << type.published
+           << ", received " << type.received << ", dropped " << type.dropped
+           << ", " << type.bytesEnqueued << " B enqueued";
+        if (type.received > 0) {
+            os << ", queued p50 " << type.queueLatency.Percentile(50)
+               << " ns p99 " << type.queueLatency.Percentile(99)
+               << " ns, processing mean "
+               << type.processingNs / type.received << " ns p99 "
+               << type.processingTime.Percentile(99) << " ns";
+        }
+        os << "\n";
+    }
+
+    for (const auto& edge : edges) {
+        os << "  from " << edge.publisher << ": delivered "
+           << edge.deliveryLatency.Count() << ", latency p50 "
+           << edge.deliveryLatency.Percentile(50) << " ns p99 "
+           << edge.deliveryLatency.Percentile(99) << " ns\n";
+    }
+
+    return os.str();
+}
+
+void NodeStatsSnapshot::WriteEdgeCsvHeader(std::ostream& os) {
+    os << "publisher,subscriber,delivered,deliveryP50Ns,deliveryP99Ns\n";
+}
+
+void NodeStatsSnapshot::WriteEdgeCsv(std::ostream& os) const {
+    for (const auto& edge : edges) {
+        os << edge.publisher << ',' << nodeName << ','
+           << edge.deliveryLatency.Count() << ','
+           << edge.deliveryLatency.Percentile(50) << ','
+           << edge.deliveryLatency.Percentile(99) << '\n';
+    }
+}
+
+void NodeStatsSnapshot::WriteCsvHeader(std::ostream& os) {
+    os << "node,type,published,received,dropped,bytesEnqueued,"
+          "queuedP50Ns,queuedP99Ns,processingNs,processingP99Ns,"
+          "maxQueueDepthHigh,maxQueueDepthNormal\n";
+}
+
+void NodeStatsSnapshot::WriteCsv(std::ostream& os) const {
+    for (size_t i = 0; i < types.size(); ++i) {
+        auto& type = types[i];
+        os << nodeName << ',' << kPacketTypeNames[i] << ',' << type.published
+           << ',' << type.received << ',' << type.dropped << ','
+           << type.bytesEnqueued << ',' << type.queueLatency.Percentile(50)
+           << ',' << type.queueLatency.Percentile(99) << ','
+           << type.processingNs << ',' << type.processingTime.Percentile(99)
+           << ',' << maxQueueDepth[0] << ',' << maxQueueDepth[1] << '\n';
+    }
+}
+
+int64_t NodeStats::Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void NodeStats::RecordPublished(PacketType type) {
+    Add(GetShard().types[static_cast<size_t>(type)].published, 1);
+}
+
+void NodeStats::RecordEnqueued(PacketType type, size_t bytes) {
+    Add(GetShard().types[static_cast<size_t>(type)].bytesEnqueued, bytes);
+}
+
+void NodeStats::RecordProcessed(PacketType type, int64_t queuedNs,
+                                int64_t processingNs) {
+    auto& counters = GetShard().types[static_cast<size_t>(type)];
+    Add(counters.received, 1);
+    Add(counters.processingNs, processingNs);
+    Add(counters.queueLatency[Histogram::BucketOf(queuedNs)], 1);
+    Add(counters.processingTime[Histogram::BucketOf(processingNs)], 1);
+}
+
+size_t NodeStats::AddEdge(std::string_view publisherName) {
+    size_t numEdges = m_numEdges.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < numEdges; ++i) {
+        if (m_edgeNames[i] == publisherName) {
+            return i;
+        }
+    }
+    if (numEdges == kMaxEdges) {
+        return kNoEdge;
+    }
+
+    m_edgeNames[numEdges] = publisherName;
+
+    // Publishes the name to Snapshot()
+    m_numEdges.store(numEdges + 1, std::memory_order_release);
+    return numEdges;
+}
+
+void NodeStats::RecordDelivered(size_t edge, int64_t latencyNs) {
+    if (edge < kMaxEdges) {
+        Add(m_edgeLatencies[edge][Histogram::BucketOf(latencyNs)], 1);
+    }
+}
+
+void NodeStats::Snapshot(NodeStatsSnapshot& snapshot) const {
+    size_t numEdges = m_numEdges.load(std::memory_order_acquire);
+    for (size_t i = 0; i < numEdges; ++i) {
+        auto edge = std::find_if(
+            snapshot.edges.begin(), snapshot.edges.end(),
+            [&](const auto& e) { return e.publisher == m_edgeNames[i]; });
+        if (edge == snapshot.edges.end()) {
+            edge = snapshot.edges.insert(snapshot.edges.end(),
+                                         {m_edgeNames[i], {}});
+        }
+        for (size_t j = 0; j < Histogram::kNumBuckets; ++j) {
+            edge->deliveryLatency.buckets[j] += Load(m_edgeLatencies[i][j]);
+        }
+    }
+
+    for (auto& shard : m_shards) {
+        for (size_t i = 0; i < shard.types.size(); ++i) {
+            auto& counters = shard.types[i];
+            auto& type = snapshot.types[i];
+            type.published += Load(counters.published);
+            type.received += Load(counters.received);
+            type.bytesEnqueued += Load(counters.bytesEnqueued);
+            type.processingNs += Load(counters.processingNs);
+            for (size_t j = 0; j < Histogram::kNumBuckets; ++j) {
+                type.queueLatency.buckets[j] += Load(counters.queueLatency[j]);
+                type.processingTime.buckets[j] +=
+                    Load(counters.processingTime[j]);
+            }
+        }
+    }
+}
+
+NodeStats::Shard& NodeStats::GetShard() {
+    return m_shards[t_shard % kNumShards];
+}
@@ -2,72 +2,355 @@
 
 #include "communications/PublishNode.hpp"
 
-#include <wpi/SmallVector.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <utility>
 
 using namespace frc3512;
 
-PublishNode::PublishNode(std::string_view nodeName) {
+namespace {
+
+// Request IDs are unique across nodes, since a reply is delivered to every
+// subscriber of the node that sends it
+std::atomic<uint32_t> g_nextRequestID{1};
+
+uint32_t NextRequestID() {
+    uint32_t id;
+    do {
+        id = g_nextRequestID.fetch_add(1, std::memory_order_relaxed);
+    } while (id == 0);
+    return id;
+}
+
+}  // namespace
+
+PublishNode::PublishNode(std::string_view nodeName, Executor& executor)
+    : Strand(executor) {
+    m_priorities.fill(MessagePriority::kNormal);
+    m_priorities[static_cast<size_t>(PacketType::kCommand)] =
+        MessagePriority::kHigh;
+
     m_nodeName = nodeName;
-    m_thread = std::thread(&PublishNode::RunFramework, this);
+    m_topicPrefixHash =
+        FnvAppend(FnvAppend(kFnvOffsetBasis, m_nodeName), "/");
+
+    m_nodeID = HashTopic(m_nodeName);
+    Recorder::GetInstance().RegisterNode(m_nodeID, m_nodeName);
 }
 
-PublishNode::~PublishNode() {
+PublishNode::~PublishNode() { Stop(); }
+
+void PublishNode::Stop() {
     m_isRunning = false;
-    m_ready.notify_all();
-    m_thread.join();
+    if (m_usesTimer) {
+        DeadlineTimer::GetInstance().Cancel(*this);
+    }
+    Close();
 }
 
-void PublishNode::Subscribe(PublishNode& publisher) {
-    auto it =
-        std::find(publisher.m_subList.begin(), publisher.m_subList.end(), this);
+void PublishNode::Subscribe(PublishNode& publisher,
+                            SubscriptionFilter filter) {
+    auto it = std::find_if(publisher.m_subList.begin(),
+                           publisher.m_subList.end(),
+                           [&](const auto& sub) { return sub.node == this; });
     if (it == publisher.m_subList.end()) {
-        publisher.m_subList.push_back(this);
+        publisher.m_subList.push_back(
+            {this, std::move(filter), m_stats.AddEdge(publisher.m_nodeName)});
+    } else {
+        it->filter = std::move(filter);
     }
 }
 
 void PublishNode::Unsubscribe(PublishNode& publisher) {
-    auto it =
-        std::find(publisher.m_subList.begin(), publisher.m_subList.end(), this);
+    auto it = std::find_if(publisher.m_subList.begin(),
+                           publisher.m_subList.end(),
+                           [&](const auto& sub) { return sub.node == this; });
     if (it != publisher.m_subList.end()) {
         publisher.m_subList.erase(it);
     }
 }
 
+void PublishNode::PublishTo(ShmWriter& writer, SubscriptionFilter filter) {
+    m_transports.push_back({&writer, std::move(filter)});
+}
+
+void PublishNode::SetOverflowPolicy(PacketType type, OverflowPolicy policy) {
+    m_overflowPolicies[static_cast<size_t>(type)] = policy;
+}
+
+void PublishNode::SetMaxAge(PacketType type, std::chrono::nanoseconds maxAge) {
+    m_maxAges[static_cast<size_t>(type)] = maxAge.count();
+}
+
+uint64_t PublishNode::GetDropCount(PacketType type) const {
+    return m_dropCounts[static_cast<size_t>(type)].load(
+        std::memory_order_relaxed);
+}
+
+void PublishNode::SetPriority(PacketType type, MessagePriority priority) {
+    m_priorities[static_cast<size_t>(type)] = priority;
+}
+
+size_t PublishNode::GetQueueDepth(MessagePriority priority) const {
+    return m_lanes[static_cast<size_t>(priority)].queue.Size();
+}
+
+size_t PublishNode::GetMaxQueueDepth(MessagePriority priority) const {
+    return m_lanes[static_cast<size_t>(priority)].maxDepth.load(
+        std::memory_order_relaxed);
+}
+
+NodeStatsSnapshot PublishNode::GetStats() const {
+    NodeStatsSnapshot snapshot;
+    snapshot.nodeName = m_nodeName;
+    m_stats.Snapshot(snapshot);
+    for (size_t i = 0; i < kNumPacketTypes; ++i) {
+        snapshot.types[i].dropped =
+            m_dropCounts[i].load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < kNumPriorities; ++i) {
+        snapshot.queueDepth[i] = m_lanes[i].queue.Size();
+        snapshot.maxQueueDepth[i] =
+            m_lanes[i].maxDepth.load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+std::string_view PublishNode::GetNodeName() const { return m_nodeName; }
+
+uint32_t PublishNode::Request(CommandPacket request,
+                              std::chrono::nanoseconds timeout,
+                              ReplyCallback callback) {
+    uint32_t id = NextRequestID();
+    int64_t deadline = NodeStats::Now() + timeout.count();
+    {
+        std::lock_guard lock(m_requestMutex);
+        m_requests.push_back({id, deadline, std::move(callback)});
+        if (deadline < m_nextDeadline) {
+            m_nextDeadline = deadline;
+        }
+    }
+    m_usesTimer = true;
+    DeadlineTimer::GetInstance().Add(deadline, *this);
+
+    request.reply = false;
+    request.requestID = id;
+    Publish(std::move(request));
+    return id;
+}
+
+std::future<bool> PublishNode::Request(CommandPacket request,
+                                       std::chrono::nanoseconds timeout) {
+    // std::function must be copyable, so the promise is shared
+    auto promise = std::make_shared<std::promise<bool>>();
+    auto future = promise->get_future();
+    Request(std::move(request), timeout,
+            [promise](const CommandPacket* reply) {
+                promise->set_value(reply != nullptr);
+            });
+    return future;
+}
+
+void PublishNode::Reply(uint32_t requestID) {
+    if (requestID == 0) {
+        return;
+    }
+
+    CommandPacket reply{"Reply", true, requestID};
+    Publish(reply);
+}
+
 bool PublishNode::GetRawButton(const HIDPacket& message, int joystick,
                                int button) {
-    if (joystick == 0) {
-        return message.buttons1 & (1 << (button - 1));
-    } else if (joystick == 1) {
-        return message.buttons2 & (1 << (button - 1));
-    } else if (joystick == 2) {
-        return message.buttons3 & (1 << (button - 1));
-    } else if (joystick == 3) {
-        return message.buttons4 & (1 << (button - 1));
-    } else {
+    if (joystick < 0 ||
+        static_cast<size_t>(joystick) >= message.buttons.size()) {
+        return false;
+    }
+
+    return message.buttons[joystick] & (1 << (button - 1));
+}
+
+PublishNode::Mailbox* PublishNode::GetMailbox(TopicID topicID) {
+    for (auto& mailbox : m_mailboxes) {
+        TopicID current = mailbox.topicID.load(std::memory_order_acquire);
+        if (current == 0 &&
+            mailbox.topicID.compare_exchange_strong(
+                current, topicID, std::memory_order_acq_rel)) {
+            return &mailbox;
+        }
+        if (current == topicID) {
+            return &mailbox;
+        }
+    }
+    return nullptr;
+}
+
+bool PublishNode::CompleteRequest(const CommandPacket& reply) {
+    if (!reply.reply || reply.requestID == 0) {
         return false;
     }
+
+    ReplyCallback callback;
+    {
+        std::lock_guard lock(m_requestMutex);
+        auto it = std::find_if(
+            m_requests.begin(), m_requests.end(),
+            [&](const auto& request) { return request.id == reply.requestID; });
+        if (it == m_requests.end()) {
+            return false;
+        }
+        callback = std::move(it->callback);
+        m_requests.erase(it);
+        UpdateNextDeadline();
+    }
+
+    // Called without the lock so the callback can make more requests
+    callback(&reply);
+    return true;
 }
 
-void PublishNode::RunFramework() {
-    while (m_isRunning) {
-        std::unique_lock<wpi::mutex> lock(m_mutex);
+void PublishNode::CompleteOrDispatch(const Message& message) {
+    if (auto reply = std::get_if<CommandPacket>(&message);
+        reply == nullptr || !CompleteRequest(*reply)) {
+        DispatchMessage(message);
+    }
+}
 
-        // Waits for queue to contain messages, but does not need to wait for
-        // queue to contain number of contents equal to the size of a complete
-        // message due to the mutex ensuring atomic message insertions.
-        m_ready.wait(lock,
-                     [this] { return m_queue.size() > 0 || !m_isRunning; });
+std::vector<uint32_t> PublishNode::GetPendingRequestIDs() {
+    std::vector<uint32_t> ids;
+    std::lock_guard lock(m_requestMutex);
+    for (const auto& request : m_requests) {
+        ids.emplace_back(request.id);
+    }
+    return ids;
+}
 
-        while (m_queue.size() > 0) {
-            // Pops first element out of queue for length of one whole message,
-            // then pops that amount elements
-            size_t msgLength = m_queue.pop_front();
-            wpi::SmallVector<char, 32> message;
-            for (size_t i = 0; i < msgLength; i++) {
-                message.push_back(m_queue.pop_front());
-            }
+void PublishNode::ExpireRequests(int64_t now) {
+    std::vector<ReplyCallback> expired;
+    {
+        std::lock_guard lock(m_requestMutex);
+        auto it = std::partition(
+            m_requests.begin(), m_requests.end(),
+            [&](const auto& request) { return request.deadline > now; });
+        for (auto request = it; request != m_requests.end(); ++request) {
+            expired.emplace_back(std::move(request->callback));
+        }
+        m_requests.erase(it, m_requests.end());
+        UpdateNextDeadline();
+    }
 
-            DeserializeAndProcessMessage(message);
+    for (auto& callback : expired) {
+        callback(nullptr);
+    }
+}
+
+void PublishNode::UpdateNextDeadline() {
+    int64_t deadline = std::numeric_limits<int64_t>::max();
+    for (const auto& request : m_requests) {
+        deadline = std::min(deadline, request.deadline);
+    }
+    m_nextDeadline = deadline;
+}
+
+void PublishNode::Process(const Envelope& envelope, int64_t& time) {
+    int64_t startTime = time;
+    size_t type = envelope.message.index();
+    int64_t sendTime = std::visit([](const auto& p) { return p.sendTime; },
+                                  envelope.message);
+
+    if (m_maxAges[type] != 0 && startTime - sendTime > m_maxAges[type]) {
+        m_dropCounts[type].fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    m_stats.RecordDelivered(envelope.edge, startTime - sendTime);
+
+    CompleteOrDispatch(envelope.message);
+    time = NodeStats::Now();
+
+    // A message queued just after the previous one finished can appear to
+    // have started before it was queued. Those count as zero wait.
+    m_stats.RecordProcessed(static_cast<PacketType>(type),
+                            startTime - envelope.enqueueTime,
+                            time - startTime);
+}
+
+bool PublishNode::ProcessMailbox(int64_t& time) {
+    Mailbox* mailbox;
+    if (!m_pendingMailboxes.Pop(mailbox)) {
+        return false;
+    }
+
+    // Copy the message out so publishers can replace it while it's processed
+    Envelope envelope;
+    {
+        std::lock_guard lock(mailbox->mutex);
+        envelope = mailbox->envelope;
+        mailbox->pending = false;
+    }
+    Process(envelope, time);
+    return true;
+}
+
+void PublishNode::RunBatch() {
+    if (!m_isRunning) {
+        return;
+    }
+
+    // Messages are moved out of their queue in one claim, then processed from
+    // here so their slots are free for producers in the meantime. A worker
+    // runs one node at a time, so each thread needs only one.
+    static thread_local std::array<Envelope, kMaxBatchSize> batch;
+
+    auto& highLane = m_lanes[static_cast<size_t>(MessagePriority::kHigh)];
+    auto& normalLane = m_lanes[static_cast<size_t>(MessagePriority::kNormal)];
+
+    int64_t time = NodeStats::Now();
+    if (m_nextDeadline <= time) {
+        ExpireRequests(time);
+    }
+
+    size_t count = highLane.queue.PopBatch(batch.begin(), batch.size());
+    for (size_t i = 0; i < count; ++i) {
+        Process(batch[i], time);
+    }
+
+    // Alternate with the mailboxes so neither starves the other. Commands
+    // that arrive in the meantime still cut in.
+    count = normalLane.queue.PopBatch(batch.begin(), batch.size());
+    Envelope command;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (highLane.queue.Pop(command)) {
+            Process(command, time);
+        }
+
+        bool processed = i < count;
+        if (processed) {
+            Process(batch[i], time);
+        }
+        processed |= ProcessMailbox(time);
+        if (!processed) {
+            break;
+        }
+    }
+}
+
+bool PublishNode::HasWork() const {
+    // Messages left over when the node deconstructs are discarded
+    if (!m_isRunning) {
+        return false;
+    }
+    for (auto& lane : m_lanes) {
+        if (!lane.queue.Empty()) {
+            return true;
         }
     }
+    if (!m_pendingMailboxes.Empty()) {
+        return true;
+    }
+
+    // Only read the clock if a request is pending
+    int64_t deadline = m_nextDeadline;
+    return deadline != std::numeric_limits<int64_t>::max() &&
+           deadline <= NodeStats::Now();
 }
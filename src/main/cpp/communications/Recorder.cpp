@@ -0,0 +1,145 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include "communications/Recorder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+#include <wpi/raw_ostream.h>
+
+#include "communications/NodeStats.hpp"
+
+using namespace frc3512;
+
+namespace {
+
+// How long the writer thread sleeps when the queue is empty. Publishers never
+// wake it, which keeps Record() down to one queue push.
+constexpr auto kWriterPeriod = std::chrono::milliseconds(5);
+
+constexpr uint8_t kNodeRecord = 0;
+constexpr uint8_t kTopicRecord = 1;
+constexpr uint8_t kMessageRecord = 2;
+
+}  // namespace
+
+Recorder& Recorder::GetInstance() {
+    static Recorder instance;
+    return instance;
+}
+
+Recorder::~Recorder() { Stop(); }
+
+bool Recorder::Start(std::string_view filename) {
+    if (m_isWriterRunning) {
+        return false;
+    }
+
+    m_file.open(std::string{filename}, std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open()) {
+        wpi::errs() << "Recorder: failed to open " << filename << "\n";
+        return false;
+    }
+
+    m_file.write(kMagic, sizeof(kMagic));
+    WriteValue(kVersion);
+    WriteValue(kSchemaHash);
+
+    // Discard anything queued after the previous recording stopped
+    Entry entry;
+    while (m_queue.Pop(entry)) {
+    }
+    m_writtenNodes.clear();
+    m_writtenTopics.clear();
+    m_startTime = NodeStats::Now();
+
+    m_isWriterRunning = true;
+    m_writerThread = std::thread([this] { WriterMain(); });
+    m_isRecording = true;
+    return true;
+}
+
+void Recorder::Stop() {
+    if (!m_isWriterRunning) {
+        return;
+    }
+
+    m_isRecording = false;
+    m_isWriterRunning = false;
+    m_writerThread.join();
+    m_file.close();
+}
+
+void Recorder::RegisterNode(NodeID id, std::string_view name) {
+    std::lock_guard lock(m_nodeNameMutex);
+    m_nodeNames.emplace(id, name);
+}
+
+uint64_t Recorder::GetDropCount() const {
+    return m_dropCount.load(std::memory_order_relaxed);
+}
+
+void Recorder::WriterMain() {
+    while (m_isWriterRunning) {
+        if (Drain() == 0) {
+            std::this_thread::sleep_for(kWriterPeriod);
+        }
+    }
+
+    // Write out what was recorded before Stop()
+    Drain();
+    m_file.flush();
+}
+
+size_t Recorder::Drain() {
+    size_t total = 0;
+    while (size_t count = m_queue.PopBatch(m_batch.begin(), m_batch.size())) {
+        for (size_t i = 0; i < count; ++i) {
+            WriteEntry(m_batch[i]);
+        }
+        total += count;
+    }
+    return total;
+}
+
+void Recorder::WriteEntry(const Entry& entry) {
+    for (NodeID node : {entry.source, entry.destination}) {
+        if (node != kNoNode && m_writtenNodes.insert(node).second) {
+            std::lock_guard lock(m_nodeNameMutex);
+            WriteName(kNodeRecord, node, m_nodeNames[node]);
+        }
+    }
+
+    std::visit(
+        [&](const auto& packet) {
+            if (packet.topicID != 0 &&
+                m_writtenTopics.insert(packet.topicID).second) {
+                WriteName(kTopicRecord, packet.topicID,
+                          TopicRegistry::GetInstance().GetName(packet.topicID));
+            }
+
+            // The buffer only grows, so it stops allocating once it fits the
+            // largest message
+            if (m_serialized.size() < packet.WireSize()) {
+                m_serialized.resize(packet.WireSize());
+            }
+            size_t size =
+                packet.Serialize(m_serialized.data(), m_serialized.size());
+            WriteValue(kMessageRecord);
+            WriteValue(entry.time - m_startTime);
+            WriteValue(entry.source);
+            WriteValue(entry.destination);
+            WriteValue(static_cast<uint16_t>(size));
+            m_file.write(m_serialized.data(), size);
+        },
+        entry.message);
+}
+
+void Recorder::WriteName(uint8_t kind, uint32_t id, std::string_view name) {
+    auto length = static_cast<uint8_t>(std::min<size_t>(name.size(), 255));
+    WriteValue(kind);
+    WriteValue(id);
+    WriteValue(length);
+    m_file.write(name.data(), length);
+}
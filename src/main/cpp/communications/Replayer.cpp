@@ -0,0 +1,200 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include "communications/Replayer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <wpi/raw_ostream.h>
+
+#include "communications/Blackboard.hpp"
+
+using namespace frc3512;
+
+namespace {
+
+constexpr uint8_t kNodeRecord = 0;
+constexpr uint8_t kTopicRecord = 1;
+constexpr uint8_t kMessageRecord = 2;
+
+/**
+ * Replaces the message with the alternative at index I or later whose
+ * PacketType matches.
+ */
+template <size_t I = 0>
+bool DeserializeAs(PacketType type, const char* buf, size_t length,
+                   Message& message) {
+    if constexpr (I < std::variant_size_v<Message>) {
+        if (static_cast<size_t>(type) == I) {
+            message.emplace<I>().Deserialize(buf, length);
+            return true;
+        }
+        return DeserializeAs<I + 1>(type, buf, length, message);
+    } else {
+        return false;
+    }
+}
+
+}  // namespace
+
+Replayer::Replayer(std::string_view filename)
+    : m_file{std::string{filename}, std::ios::binary} {
+    char magic[sizeof(Recorder::kMagic)];
+    uint32_t version = 0;
+    uint32_t schemaHash = 0;
+    if (!m_file.read(magic, sizeof(magic)) || !ReadValue(version) ||
+        !ReadValue(schemaHash) ||
+        std::memcmp(magic, Recorder::kMagic, sizeof(magic)) != 0 ||
+        version != Recorder::kVersion || schemaHash != kSchemaHash) {
+        wpi::errs() << "Replayer: " << filename
+                    << " isn't a recording with this program's message "
+                       "schema\n";
+        m_file.close();
+        return;
+    }
+
+    m_firstRecord = m_file.tellg();
+}
+
+bool Replayer::IsOpen() const { return m_file.is_open(); }
+
+void Replayer::AddNode(PublishNode& node) {
+    m_nodes[HashTopic(node.GetNodeName())] = &node;
+}
+
+size_t Replayer::Run(ReplaySpeed speed) {
+    if (!IsOpen()) {
+        return 0;
+    }
+
+    m_file.clear();
+    m_file.seekg(m_firstRecord);
+    m_requestIDs.clear();
+
+    auto startTime = std::chrono::steady_clock::now();
+    size_t delivered = 0;
+    std::vector<char> buffer;
+    Message message;
+    uint8_t kind;
+    while (ReadValue(kind)) {
+        if (kind == kNodeRecord || kind == kTopicRecord) {
+            uint32_t id;
+            uint8_t length;
+            char name[256];
+            if (!ReadValue(id) || !ReadValue(length) ||
+                !m_file.read(name, length)) {
+                break;
+            }
+
+            // Node names are only needed to match AddNode(), which uses the
+            // same hash. Topic names are interned so deserialized packets
+            // get them back.
+            if (kind == kTopicRecord) {
+                std::string_view fullName{name, length};
+                auto slash = fullName.find('/');
+                TopicRegistry::GetInstance().Intern(
+                    id, fullName.substr(0, slash),
+                    slash == std::string_view::npos
+                        ? std::string_view{}
+                        : fullName.substr(slash + 1));
+            }
+            continue;
+        } else if (kind != kMessageRecord) {
+            wpi::errs() << "Replayer: unknown record kind "
+                        << static_cast<int>(kind) << "\n";
+            break;
+        }
+
+        int64_t time;
+        NodeID sourceID;
+        NodeID destination;
+        uint16_t length;
+        if (!ReadValue(time) || !ReadValue(sourceID) ||
+            !ReadValue(destination) || !ReadValue(length)) {
+            break;
+        }
+        buffer.resize(length);
+        if (!m_file.read(buffer.data(), length)) {
+            // The recording was cut off mid-record
+            break;
+        }
+
+        PublishNode* node = nullptr;
+        if (destination != Recorder::kNoNode) {
+            auto it = m_nodes.find(destination);
+            if (it == m_nodes.end()) {
+                continue;
+            }
+            node = it->second;
+        }
+
+        if (length == 0 || !Deserialize(buffer.data(), length, message)) {
+            continue;
+        }
+
+        if (speed == ReplaySpeed::kRealTime) {
+            std::this_thread::sleep_until(startTime +
+                                          std::chrono::nanoseconds(time));
+        }
+
+        if (node == nullptr) {
+            if (auto source = m_nodes.find(sourceID); source != m_nodes.end()) {
+                MatchRequest(*source->second, message);
+            }
+            std::visit(
+                [](const auto& packet) {
+                    using P = std::decay_t<decltype(packet)>;
+                    if constexpr (std::is_trivially_copyable_v<P>) {
+                        Blackboard::GetInstance().Write(packet);
+                    }
+                },
+                message);
+        } else {
+            // Replies are addressed to the request IDs of the recorded run
+            if (auto reply = std::get_if<CommandPacket>(&message);
+                reply != nullptr && reply->reply) {
+                if (auto id = m_requestIDs.find(reply->requestID);
+                    id != m_requestIDs.end()) {
+                    reply->requestID = id->second;
+                }
+            }
+
+            node->CompleteOrDispatch(message);
+            ++delivered;
+        }
+    }
+
+    return delivered;
+}
+
+bool Replayer::Deserialize(const char* buf, size_t length, Message& message) {
+    return DeserializeAs(static_cast<PacketType>(buf[0]), buf, length,
+                         message);
+}
+
+void Replayer::MatchRequest(PublishNode& node, const Message& message) {
+    auto request = std::get_if<CommandPacket>(&message);
+    if (request == nullptr || request->reply || request->requestID == 0) {
+        return;
+    }
+
+    // Request IDs only increase, so the oldest request the node made that
+    // isn't matched yet is the one the recording has reached
+    uint32_t match = 0;
+    for (auto id : node.GetPendingRequestIDs()) {
+        bool isMatched = std::any_of(
+            m_requestIDs.begin(), m_requestIDs.end(),
+            [&](const auto& entry) { return entry.second == id; });
+        if (!isMatched && (match == 0 || id < match)) {
+            match = id;
+        }
+    }
+    if (match != 0) {
+        m_requestIDs[request->requestID] = match;
+    }
+}
@@ -0,0 +1,224 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include "communications/ShmTransport.hpp"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <array>
+#include <climits>
+#include <cstring>
+#include <utility>
+#include <variant>
+
+#include <wpi/raw_ostream.h>
+
+#include "dsdisplay/PacketReader.hpp"
+
+using namespace frc3512;
+
+namespace {
+
+using Deserializer = void (*)(PacketReader&, Message&);
+
+template <size_t I>
+void DeserializeAlternative(PacketReader& reader, Message& message) {
+    message.emplace<I>().Deserialize(reader);
+}
+
+template <size_t... I>
+constexpr std::array<Deserializer, sizeof...(I)> MakeDeserializers(
+    std::index_sequence<I...>) {
+    return {&DeserializeAlternative<I>...};
+}
+
+// Deserializes each packet type, indexed by PacketType. Message's
+// alternatives are in PacketType order.
+constexpr auto kDeserializers = MakeDeserializers(
+    std::make_index_sequence<std::variant_size_v<Message>>{});
+
+uint32_t RoundUpToPowerOfTwo(uint32_t value) {
+    uint32_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+uint32_t* FutexAddress(std::atomic<uint32_t>& word) {
+    return reinterpret_cast<uint32_t*>(&word);
+}
+
+/**
+ * Maps the given shared memory object.
+ *
+ * @return The mapping, or nullptr on failure.
+ */
+void* Map(int fd, size_t size) {
+    void* mapping =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    return mapping == MAP_FAILED ? nullptr : mapping;
+}
+
+}  // namespace
+
+ShmWriter::ShmWriter(std::string_view name, uint32_t numSlots)
+    : m_name{name} {
+    numSlots = RoundUpToPowerOfTwo(numSlots);
+
+    // A ring left behind by a previous run may still have readers attached.
+    // They keep the old mapping while new readers get a fresh one.
+    shm_unlink(m_name.c_str());
+    int fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd == -1) {
+        wpi::errs() << "ShmWriter: failed to create " << m_name << ": "
+                    << std::strerror(errno) << "\n";
+        return;
+    }
+
+    size_t size = ShmRing::MappingSize(numSlots);
+    void* mapping = nullptr;
+    if (ftruncate(fd, size) == 0) {
+        mapping = Map(fd, size);
+    }
+    close(fd);
+    if (mapping == nullptr) {
+        wpi::errs() << "ShmWriter: failed to map " << m_name << ": "
+                    << std::strerror(errno) << "\n";
+        shm_unlink(m_name.c_str());
+        return;
+    }
+
+    // ftruncate() zero-fills the object, so the atomics and sequence numbers
+    // already start at zero
+    m_mapping = mapping;
+    m_mappingSize = size;
+    m_header = static_cast<ShmRing::Header*>(mapping);
+    m_slots = reinterpret_cast<ShmRing::Slot*>(m_header + 1);
+    m_mask = numSlots - 1;
+
+    m_header->version = ShmRing::kVersion;
+    m_header->numSlots = numSlots;
+    m_header->maxPacketSize = ShmRing::kMaxPacketSize;
+    m_header->schemaHash = kSchemaHash;
+    m_header->magic.store(ShmRing::kMagic, std::memory_order_release);
+}
+
+ShmWriter::~ShmWriter() {
+    if (m_mapping != nullptr) {
+        munmap(m_mapping, m_mappingSize);
+        shm_unlink(m_name.c_str());
+    }
+}
+
+bool ShmWriter::IsOpen() const { return m_header != nullptr; }
+
+void ShmWriter::WakeReaders() {
+    syscall(SYS_futex, FutexAddress(m_header->futexWord), FUTEX_WAKE, INT_MAX,
+            nullptr, nullptr, 0);
+}
+
+ShmReader::ShmReader(std::string_view name) {
+    std::string nameString{name};
+    int fd = shm_open(nameString.c_str(), O_RDWR, 0);
+    if (fd == -1) {
+        wpi::errs() << "ShmReader: failed to open " << nameString << ": "
+                    << std::strerror(errno) << "\n";
+        return;
+    }
+
+    struct stat status;
+    void* mapping = nullptr;
+    if (fstat(fd, &status) == 0 &&
+        static_cast<size_t>(status.st_size) >= sizeof(ShmRing::Header)) {
+        mapping = Map(fd, status.st_size);
+    }
+    close(fd);
+    if (mapping == nullptr) {
+        wpi::errs() << "ShmReader: failed to map " << nameString << "\n";
+        return;
+    }
+
+    auto header = static_cast<ShmRing::Header*>(mapping);
+    if (header->magic.load(std::memory_order_acquire) != ShmRing::kMagic ||
+        header->version != ShmRing::kVersion ||
+        header->maxPacketSize != ShmRing::kMaxPacketSize ||
+        header->schemaHash != kSchemaHash ||
+        ShmRing::MappingSize(header->numSlots) >
+            static_cast<size_t>(status.st_size)) {
+        wpi::errs() << "ShmReader: " << nameString
+                    << " was written by a program with a different message "
+                       "schema\n";
+        munmap(mapping, status.st_size);
+        return;
+    }
+
+    m_mapping = mapping;
+    m_mappingSize = status.st_size;
+    m_header = header;
+    m_slots = reinterpret_cast<ShmRing::Slot*>(m_header + 1);
+    m_mask = header->numSlots - 1;
+    m_nextIndex = header->writeIndex.load(std::memory_order_acquire);
+}
+
+ShmReader::~ShmReader() {
+    if (m_mapping != nullptr) {
+        munmap(m_mapping, m_mappingSize);
+    }
+}
+
+bool ShmReader::IsOpen() const { return m_header != nullptr; }
+
+bool ShmReader::Wait(std::chrono::nanoseconds timeout) {
+    if (m_header == nullptr) {
+        return false;
+    }
+
+    // Load the futex word before checking for a message so a write between
+    // the check and the futex call makes the futex call return immediately
+    uint32_t word = m_header->futexWord.load(std::memory_order_acquire);
+    if (HasMessage()) {
+        return true;
+    }
+
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    timespec relativeTimeout;
+    relativeTimeout.tv_sec = seconds.count();
+    relativeTimeout.tv_nsec = (timeout - seconds).count();
+
+    // A reader that times out leaves the flag set, which costs the next write
+    // one unneeded wake
+    m_header->hasWaiters.store(1, std::memory_order_seq_cst);
+    syscall(SYS_futex, FutexAddress(m_header->futexWord), FUTEX_WAIT, word,
+            &relativeTimeout, nullptr, 0);
+
+    return HasMessage();
+}
+
+uint64_t ShmReader::GetLostCount() const { return m_lostCount; }
+
+bool ShmReader::HasMessage() const {
+    // A slot from a later lap has a larger sequence number, so a reader that
+    // was lapped also sees a message
+    const ShmRing::Slot& slot = m_slots[m_nextIndex & m_mask];
+    return slot.sequence.load(std::memory_order_acquire) >=
+           2 * m_nextIndex + 2;
+}
+
+bool ShmReader::Deserialize(const char* data, size_t size, Message& message) {
+    if (size == 0) {
+        return false;
+    }
+    auto packetType = static_cast<uint8_t>(data[0]);
+    if (packetType >= kDeserializers.size()) {
+        return false;
+    }
+
+    PacketReader reader{data, size};
+    kDeserializers[packetType](reader, message);
+    return static_cast<bool>(reader);
+}
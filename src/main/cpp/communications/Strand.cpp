@@ -0,0 +1,59 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include "communications/Strand.hpp"
+
+#include <thread>
+
+#include "communications/Executor.hpp"
+
+using namespace frc3512;
+
+Strand::Strand(Executor& executor) : m_executor(executor) {
+    m_executor.AddStrand();
+}
+
+Strand::~Strand() { m_executor.RemoveStrand(); }
+
+void Strand::Notify() {
+    // The exchange is a read-modify-write, so it either sees the flag Run()
+    // cleared, or Run() sees the work published before it
+    if (!m_isScheduled.exchange(true, std::memory_order_acq_rel)) {
+        m_executor.Schedule(*this);
+    }
+}
+
+void Strand::Close() {
+    // The flag stays claimed after the first call, so another claim would
+    // never succeed
+    if (m_isClosed) {
+        return;
+    }
+    m_isClosed = true;
+
+    // Claiming the flag keeps producers from scheduling the strand. If a
+    // worker holds it, wait for the batch to finish.
+    while (m_isScheduled.exchange(true, std::memory_order_acq_rel)) {
+        std::this_thread::yield();
+    }
+
+    // A worker that cleared the flag may still be in Run()
+    while (m_numRunning.load(std::memory_order_acquire) > 0) {
+        std::this_thread::yield();
+    }
+}
+
+void Strand::Run() {
+    // Counted while the flag is still set, so Close() can't have claimed it
+    m_numRunning.fetch_add(1, std::memory_order_relaxed);
+
+    RunBatch();
+
+    m_isScheduled.exchange(false, std::memory_order_acq_rel);
+    if (HasWork() && !m_isScheduled.exchange(true, std::memory_order_acq_rel)) {
+        m_executor.Schedule(*this);
+    }
+
+    // This must be the last use of the strand. Once it's zero, Close() may
+    // return and the strand may be destroyed.
+    m_numRunning.fetch_sub(1, std::memory_order_release);
+}
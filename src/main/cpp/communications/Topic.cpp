@@ -0,0 +1,82 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include "communications/Topic.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+using namespace frc3512;
+
+TopicRegistry& TopicRegistry::GetInstance() {
+    static TopicRegistry instance;
+    return instance;
+}
+
+std::string_view TopicRegistry::Intern(TopicID id, std::string_view nodeName,
+                                       std::string_view topic) {
+    return InternParts(id, {nodeName, "/", topic});
+}
+
+std::string_view TopicRegistry::Intern(TopicID id, std::string_view name) {
+    return InternParts(id, {name});
+}
+
+std::string_view TopicRegistry::InternParts(
+    TopicID id, std::initializer_list<std::string_view> parts) {
+    for (size_t probe = 0; probe < kMaxTopics; ++probe) {
+        auto& entry = m_entries[(id + probe) % kMaxTopics];
+
+        TopicID current = entry.id.load(std::memory_order_acquire);
+        if (current == 0) {
+            if (entry.id.compare_exchange_strong(current, id,
+                                                 std::memory_order_acq_rel)) {
+                // This thread claimed the entry, so fill in the name
+                size_t length = 0;
+                auto append = [&](std::string_view str) {
+                    size_t count =
+                        std::min(str.size(), kMaxTopicLength - length);
+                    std::memcpy(entry.name + length, str.data(), count);
+                    length += count;
+                };
+                for (auto part : parts) {
+                    append(part);
+                }
+                entry.length = static_cast<uint8_t>(length);
+                entry.ready.store(true, std::memory_order_release);
+                return entry.Name();
+            }
+
+            // Another thread claimed the entry first. If it was for a
+            // different topic, keep probing.
+        }
+
+        if (current == id) {
+            // Another thread may still be writing the name
+            while (!entry.ready.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            return entry.Name();
+        }
+    }
+
+    return {};
+}
+
+std::string_view TopicRegistry::GetName(TopicID id) const {
+    for (size_t probe = 0; probe < kMaxTopics; ++probe) {
+        auto& entry = m_entries[(id + probe) % kMaxTopics];
+
+        TopicID current = entry.id.load(std::memory_order_acquire);
+        if (current == 0) {
+            return {};
+        } else if (current == id) {
+            if (!entry.ready.load(std::memory_order_acquire)) {
+                return {};
+            }
+            return entry.Name();
+        }
+    }
+
+    return {};
+}
@@ -2,9 +2,18 @@
 
 #include "dsdisplay/DSDisplay.hpp"
 
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
 #include <cstring>
 #include <fstream>
 #include <memory>
+#include <string_view>
 
 #include <frc/Filesystem.h>
 #include <wpi/Path.h>
@@ -12,8 +21,9 @@
 #include <wpi/Twine.h>
 #include <wpi/raw_ostream.h>
 
+#include "dsdisplay/PacketReader.hpp"
+
 using namespace frc3512;
-using namespace std::chrono_literals;
 
 DSDisplay::DSDisplay(int port) : m_dsPort(port) {
     m_socket.bind(port);
@@ -39,93 +49,71 @@ DSDisplay::DSDisplay(int port) : m_dsPort(port) {
         m_curAutonMode = 0;
     }
 
+    if (!CreateEventFds()) {
+        wpi::errs() << "dsdisplay: failed to create event descriptors: "
+                    << std::strerror(errno) << "\n";
+        return;
+    }
+
     m_recvRunning = true;
-    m_recvThread = std::thread([this] {
-        while (m_recvRunning) {
-            ReceiveFromDS();
-            std::this_thread::sleep_for(10ms);
-        }
-    });
+    m_recvThread = std::thread([this] { RunReceiveLoop(); });
 }
 
 DSDisplay::~DSDisplay() {
-    m_recvRunning = false;
-    m_recvThread.join();
-}
-
-void DSDisplay::Clear() { m_packet.clear(); }
-
-void DSDisplay::AddData(std::string ID, StatusLight data) {
-    // If packet is empty, add "display\r\n" header to packet
-    if (m_packet.getData() == nullptr) {
-        m_packet << std::string("display\r\n");
+    if (m_recvThread.joinable()) {
+        m_recvRunning = false;
+        uint64_t one = 1;
+        [[maybe_unused]] auto written =
+            write(m_stopEventFd, &one, sizeof(one));
+        m_recvThread.join();
     }
 
-    m_packet << static_cast<int8_t>('c');
-    m_packet << ID;
-    m_packet << static_cast<int8_t>(data);
+    for (int fd : {m_epollFd, m_keepaliveTimerFd, m_stopEventFd}) {
+        if (fd != -1) {
+            close(fd);
+        }
+    }
 }
 
-void DSDisplay::AddData(std::string ID, bool data) {
-    // If packet is empty, add "display\r\n" header to packet
-    if (m_packet.getData() == nullptr) {
-        m_packet << std::string("display\r\n");
-    }
+void DSDisplay::Clear() { m_packet.clear(); }
 
-    m_packet << static_cast<int8_t>('c');
-    m_packet << ID;
+void DSDisplay::AddData(std::string_view ID, StatusLight data) {
+    AddData(ID, static_cast<int8_t>(data));
+}
 
+void DSDisplay::AddData(std::string_view ID, bool data) {
     if (data == true) {
-        m_packet << static_cast<int8_t>(DSDisplay::active);
+        AddData(ID, static_cast<int8_t>(DSDisplay::active));
     } else {
-        m_packet << static_cast<int8_t>(DSDisplay::inactive);
+        AddData(ID, static_cast<int8_t>(DSDisplay::inactive));
     }
 }
 
-void DSDisplay::AddData(std::string ID, int8_t data) {
-    // If packet is empty, add "display\r\n" header to packet
-    if (m_packet.getData() == nullptr) {
-        m_packet << std::string("display\r\n");
-    }
-
-    m_packet << static_cast<int8_t>('c');
-    m_packet << ID;
-    m_packet << data;
+void DSDisplay::AddData(std::string_view ID, int8_t data) {
+    AddValue(ID, 'c', {reinterpret_cast<const char*>(&data), sizeof(data)});
 }
 
-void DSDisplay::AddData(std::string ID, int32_t data) {
-    // If packet is empty, add "display\r\n" header to packet
-    if (m_packet.getData() == nullptr) {
-        m_packet << std::string("display\r\n");
-    }
-
-    m_packet << static_cast<int8_t>('i');
-    m_packet << ID;
-    m_packet << data;
+void DSDisplay::AddData(std::string_view ID, int32_t data) {
+    // Written in network byte order like Packet does
+    int32_t toWrite = htonl(data);
+    AddValue(ID, 'i',
+             {reinterpret_cast<const char*>(&toWrite), sizeof(toWrite)});
 }
 
-void DSDisplay::AddData(std::string ID, std::string data) {
-    // If packet is empty, add "display\r\n" header to packet
-    if (m_packet.getData() == nullptr) {
-        m_packet << std::string("display\r\n");
-    }
-
-    m_packet << static_cast<int8_t>('s');
-    m_packet << ID;
-    m_packet << data;
+void DSDisplay::AddData(std::string_view ID, std::string_view data) {
+    AddValue(ID, 's', data);
 }
 
-void DSDisplay::AddData(std::string ID, double data) {
-    // If packet is empty, add "display\r\n" header to packet
-    if (m_packet.getData() == nullptr) {
+void DSDisplay::AddData(std::string_view ID, double data) {
+    StartFrame();
+    if (m_isCompact) {
+        // Written in host byte order like Packet does
+        AddValue(ID, 'd', {reinterpret_cast<const char*>(&data), sizeof(data)});
+    } else {
         // doubles are converted to strings because VxWorks messes up floating
         // point values over the network.
-        m_packet << std::string("display\r\n");
+        AddValue(ID, 's', std::to_string(data));
     }
-
-    m_packet << static_cast<int8_t>('s');
-    m_packet << ID;
-    m_packet << std::to_string(data);
 }
 
 void DSDisplay::SendToDS() {
@@ -138,10 +126,17 @@ void DSDisplay::SendToDS() {
         dsPort = m_dsPort;
     }
 
-    if (dsIP != 0) {
+    StartFrame();
+
+    // Compact frames are built even when no Driver Station is connected so
+    // unsent changes don't pile up
+    bool hasData = m_isCompact ? BuildCompactFrame()
+                               : m_packet.getData() != nullptr;
+    if (dsIP != 0 && hasData) {
         m_socket.send(m_packet, dsIP, dsPort);
-        Clear();
     }
+    Clear();
+    m_isFrameStarted = false;
 }
 
 void DSDisplay::AddAutoMethod(std::string methodName,
@@ -172,114 +167,293 @@ void DSDisplay::SendToDS(Packet& packet) {
     // this point.
     if (m_dsIP != 0) {
         m_socket.send(packet, m_dsIP, m_dsPort);
-        m_packet.clear();
+        packet.clear();
     }
 }
 
-void DSDisplay::ReceiveFromDS() {
-    // Send keepalive every 250ms
-    auto time = steady_clock::now();
-    if (time - m_prevTime > 250ms) {
-        Packet packet;
-        packet << static_cast<std::string>("\r\n");
-        SendToDS(packet);
+void DSDisplay::StartFrame() {
+    if (m_isFrameStarted) {
+        return;
+    }
+    m_isFrameStarted = true;
 
-        m_prevTime = time;
+    // Switch formats only between frames so a frame is never half of each
+    bool isCompact = m_compactRequested.load(std::memory_order_relaxed);
+    if (isCompact != m_isCompact) {
+        m_isCompact = isCompact;
+        m_framesUntilKeyframe = 0;
     }
+}
 
-    if (m_socket.receive(m_recvBuffer, 256, m_recvAmount, m_recvIP,
-                         m_recvPort) == UdpSocket::Done) {
-        if (std::strncmp(m_recvBuffer, "connect\r\n", 9) == 0) {
-            {
-                std::lock_guard lock(m_ipMutex);
-                m_dsIP = m_recvIP;
-                m_dsPort = m_recvPort;
+void DSDisplay::AddValue(std::string_view ID, int8_t type,
+                         std::string_view value) {
+    StartFrame();
+    if (!m_isCompact) {
+        // If packet is empty, add "display\r\n" header to packet
+        if (m_packet.getData() == nullptr) {
+            m_packet << std::string("display\r\n");
+        }
+
+        m_packet << type;
+        m_packet << ID;
+        AppendValue(m_packet, type, value);
+        return;
+    }
+
+    auto& element = m_elements[InternElement(ID)];
+    if (element.type != type || element.value != value) {
+        element.type = type;
+        // Reuses the string's capacity once the element has been seen
+        element.value.assign(value.data(), value.size());
+        element.isChanged = true;
+    }
+}
+
+void DSDisplay::AppendValue(Packet& packet, int8_t type,
+                            std::string_view value) {
+    if (type == 's') {
+        packet << value;
+    } else {
+        packet.append(value.data(), value.size());
+    }
+}
+
+uint16_t DSDisplay::InternElement(std::string_view name) {
+    if (auto it = m_elementIDs.find(name); it != m_elementIDs.end()) {
+        return it->second;
+    }
+
+    auto ID = static_cast<uint16_t>(m_elements.size());
+    m_elementIDs.emplace(name, ID);
+    m_elements.emplace_back().name = name;
+    return ID;
+}
+
+bool DSDisplay::BuildCompactFrame() {
+    bool isKeyframe = m_keyframeRequested.exchange(false) ||
+                      m_framesUntilKeyframe == 0;
+    if (isKeyframe) {
+        m_framesUntilKeyframe = kKeyframeInterval;
+    }
+    --m_framesUntilKeyframe;
+
+    m_packet << std::string("displayCompact\r\n");
+    m_packet << static_cast<uint8_t>(isKeyframe);
+
+    // Each record starts with a type character and the element's ID. 'n'
+    // records assign a name to the ID and the rest set its value.
+    bool hasData = false;
+    for (size_t i = 0; i < m_elements.size(); ++i) {
+        auto ID = static_cast<uint16_t>(i);
+        auto& element = m_elements[i];
+
+        if (isKeyframe || !element.isDefined) {
+            m_packet << static_cast<int8_t>('n') << ID;
+            m_packet << std::string_view{element.name};
+            element.isDefined = true;
+            hasData = true;
+        }
+
+        if (isKeyframe || element.isChanged) {
+            m_packet << element.type << ID;
+            AppendValue(m_packet, element.type, element.value);
+            element.isChanged = false;
+            hasData = true;
+        }
+    }
+
+    return hasData;
+}
+
+bool DSDisplay::CreateEventFds() {
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_keepaliveTimerFd =
+        timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    m_stopEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_epollFd == -1 || m_keepaliveTimerFd == -1 || m_stopEventFd == -1) {
+        return false;
+    }
+
+    itimerspec keepalive{};
+    keepalive.it_interval.tv_nsec = 250000000;
+    keepalive.it_value = keepalive.it_interval;
+    if (timerfd_settime(m_keepaliveTimerFd, 0, &keepalive, nullptr) == -1) {
+        return false;
+    }
+
+    for (int fd : {m_socket.getHandle(), m_keepaliveTimerFd, m_stopEventFd}) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) == -1) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void DSDisplay::RunReceiveLoop() {
+    while (m_recvRunning) {
+        std::array<epoll_event, 3> events;
+        int count = epoll_wait(m_epollFd, events.data(), events.size(), -1);
+        if (count == -1) {
+            if (errno != EINTR) {
+                wpi::errs() << "dsdisplay: epoll_wait failed: "
+                            << std::strerror(errno) << "\n";
+                return;
+            }
+            continue;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == m_keepaliveTimerFd) {
+                // Clear the expiration count so the descriptor stops being
+                // readable. Missed expirations only need one keepalive.
+                uint64_t expirations;
+                if (read(fd, &expirations, sizeof(expirations)) > 0) {
+                    SendKeepalive();
+                }
+            } else if (fd == m_socket.getHandle()) {
+                // The socket is non-blocking, so this stops once it's drained
+                while (ReceiveFromDS()) {
+                }
             }
+        }
+    }
+}
+
+void DSDisplay::SendKeepalive() {
+    m_arena.Reset();
+
+    Packet packet{m_arena};
+    packet << static_cast<std::string>("\r\n");
+    SendToDS(packet);
+}
 
-            // Send GUI element file to DS
+bool DSDisplay::ReceiveFromDS() {
+    // Packets from the previous call have all been sent and destroyed
+    m_arena.Reset();
 
-            Packet packet;
-            packet << static_cast<std::string>("guiCreate\r\n");
+    if (m_socket.receive(m_recvBuffer, 256, m_recvAmount, m_recvIP,
+                         m_recvPort) != UdpSocket::Done) {
+        return false;
+    }
 
-            // Open the file
+    // Requests are read in place. The command names aren't length-prefixed like
+    // strings written by Packet, so they're matched as raw bytes.
+    PacketReader request{m_recvBuffer, m_recvAmount};
+    std::string_view received{m_recvBuffer, m_recvAmount};
+
+    bool isCompactConnect = received.substr(0, 16) == "connectCompact\r\n";
+    if (isCompactConnect || received.substr(0, 9) == "connect\r\n") {
+        {
+            std::lock_guard lock(m_ipMutex);
+            m_dsIP = m_recvIP;
+            m_dsPort = m_recvPort;
+        }
+
+        // The next frame started uses the requested format. The new Driver
+        // Station doesn't know any element IDs yet, so that frame is a
+        // keyframe.
+        m_compactRequested = isCompactConnect;
+        m_keyframeRequested = true;
+
+        // Send GUI element file to DS
+
+        Packet packet{m_arena};
+        packet << static_cast<std::string>("guiCreate\r\n");
+
+        // Open the file
 #ifdef __FRC_ROBORIO__
-            std::ifstream guiFile("GUISettings.txt", std::ifstream::binary);
+        std::ifstream guiFile("GUISettings.txt", std::ifstream::binary);
 #else
-            std::ifstream guiFile("GUISettings.txt", std::ifstream::binary);
+        std::ifstream guiFile("GUISettings.txt", std::ifstream::binary);
 #endif
 
-            if (guiFile.is_open()) {
-                // Get its length
-                guiFile.seekg(0, guiFile.end);
-                unsigned int fileSize = guiFile.tellg();
-                guiFile.seekg(0, guiFile.beg);
+        if (guiFile.is_open()) {
+            // Get its length
+            guiFile.seekg(0, guiFile.end);
+            unsigned int fileSize = guiFile.tellg();
+            guiFile.seekg(0, guiFile.beg);
 
-                // Send the length
-                packet << static_cast<uint32_t>(fileSize);
+            // Send the length
+            packet << static_cast<uint32_t>(fileSize);
 
-                // Allocate a buffer for the file
-                auto tempBuf = std::make_unique<char[]>(fileSize);
+            // Allocate a buffer for the file
+            auto tempBuf = std::make_unique<char[]>(fileSize);
 
-                // Send the data
-                guiFile.read(tempBuf.get(), fileSize);
-                packet.append(tempBuf.get(), fileSize);
+            // Send the data
+            guiFile.read(tempBuf.get(), fileSize);
+            packet.append(tempBuf.get(), fileSize);
 
-                guiFile.close();
-            }
+            guiFile.close();
+        }
 
-            SendToDS(packet);
+        SendToDS(packet);
 
-            // Send a list of available autonomous modes
-            packet.clear();
+        // Send a list of available autonomous modes
+        packet.clear();
 
-            packet << static_cast<std::string>("autonList\r\n");
+        packet << static_cast<std::string>("autonList\r\n");
 
-            for (unsigned int i = 0; i < m_autonModes.size(); i++) {
-                packet << std::get<0>(m_autonModes[i]);
-            }
+        for (unsigned int i = 0; i < m_autonModes.size(); i++) {
+            packet << std::get<0>(m_autonModes[i]);
+        }
 
-            SendToDS(packet);
+        SendToDS(packet);
 
-            // Make sure driver knows which autonomous mode is selected
-            packet.clear();
+        // Make sure driver knows which autonomous mode is selected
+        packet.clear();
 
-            packet << static_cast<std::string>("autonConfirmed\r\n");
+        packet << static_cast<std::string>("autonConfirmed\r\n");
+        if (static_cast<size_t>(m_curAutonMode) < m_autonModes.size()) {
+            // The mode restored from autonMode.txt may not exist anymore
             packet << std::get<0>(m_autonModes[m_curAutonMode]);
+        }
 
-            SendToDS(packet);
-        } else if (std::strncmp(m_recvBuffer, "autonSelect\r\n", 13) == 0) {
-            // Next byte after command is selection choice
-            m_curAutonMode = m_recvBuffer[13];
+        SendToDS(packet);
+    } else if (received.substr(0, 13) == "autonSelect\r\n") {
+        // Next byte after command is selection choice
+        uint8_t selection;
+        request.ReadBytes(13);
+        request >> selection;
+        if (!request || selection >= m_autonModes.size()) {
+            wpi::errs() << "dsdisplay: autonSelect: invalid selection\n";
+            return true;
+        }
+        m_curAutonMode = selection;
 
-            Packet packet;
+        Packet packet{m_arena};
 
-            packet << static_cast<std::string>("autonConfirmed\r\n");
-            packet << std::get<0>(m_autonModes[m_curAutonMode]);
+        packet << static_cast<std::string>("autonConfirmed\r\n");
+        packet << std::get<0>(m_autonModes[m_curAutonMode]);
 
-            // Store newest autonomous choice to file for persistent storage
-            wpi::SmallString<64> path;
-            frc::filesystem::GetOperatingDirectory(path);
-            wpi::sys::path::append(path, "autonMode.txt");
-            std::ofstream autonModeFile(wpi::Twine{path}.str(),
-                                        std::fstream::trunc);
-            if (autonModeFile.is_open()) {
-                // Selection is stored as ASCII number in file
-                char autonNum = '0' + m_curAutonMode;
-
-                if (autonModeFile << autonNum) {
-                    wpi::outs() << "dsdisplay: autonSelect: wrote auton "
-                                << autonNum << " to file\n";
-                } else {
-                    wpi::errs()
-                        << "dsdisplay: autonSelect: failed writing auton "
-                        << autonNum << " into open file\n";
-                }
+        // Store newest autonomous choice to file for persistent storage
+        wpi::SmallString<64> path;
+        frc::filesystem::GetOperatingDirectory(path);
+        wpi::sys::path::append(path, "autonMode.txt");
+        std::ofstream autonModeFile(wpi::Twine{path}.str(),
+                                    std::fstream::trunc);
+        if (autonModeFile.is_open()) {
+            // Selection is stored as ASCII number in file
+            char autonNum = '0' + m_curAutonMode;
+
+            if (autonModeFile << autonNum) {
+                wpi::outs() << "dsdisplay: autonSelect: wrote auton "
+                            << autonNum << " to file\n";
             } else {
-                wpi::errs()
-                    << "dsdisplay: autonSelect: failed to open autonMode.txt\n";
+                wpi::errs() << "dsdisplay: autonSelect: failed writing auton "
+                            << autonNum << " into open file\n";
             }
-
-            SendToDS(packet);
+        } else {
+            wpi::errs()
+                << "dsdisplay: autonSelect: failed to open autonMode.txt\n";
         }
+
+        SendToDS(packet);
     }
+
+    return true;
 }
@@ -1,33 +1,152 @@
-// Copyright (c) 2017-2019 FRC Team 3512. All Rights Reserved.
+// Copyright (c) 2017-2020 FRC Team 3512. All Rights Reserved.
 
 #include "dsdisplay/Packet.hpp"
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
 
+#include <algorithm>
 #include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "dsdisplay/PacketReader.hpp"
 
 using namespace frc3512;
 
+Packet::Packet(PacketArena& arena) : m_arena{&arena} {}
+
+Packet::Packet(const Packet& rhs) : m_arena{rhs.m_arena} { *this = rhs; }
+
+Packet::Packet(Packet&& rhs) noexcept { *this = std::move(rhs); }
+
+Packet& Packet::operator=(const Packet& rhs) {
+    if (this != &rhs) {
+        m_size = 0;
+        append(rhs.m_data, rhs.m_size);
+        m_isValid = rhs.m_isValid;
+        m_readPos = rhs.m_readPos;
+    }
+    return *this;
+}
+
+Packet& Packet::operator=(Packet&& rhs) noexcept {
+    if (this == &rhs) {
+        return *this;
+    }
+
+    if (rhs.m_data == rhs.m_inline) {
+        std::memcpy(m_inline, rhs.m_inline, rhs.m_size);
+        m_data = m_inline;
+        m_capacity = kInlineSize;
+        m_heap.reset();
+    } else {
+        // Take the spilled storage, whether it's in the heap or an arena
+        m_data = rhs.m_data;
+        m_capacity = rhs.m_capacity;
+        m_heap = std::move(rhs.m_heap);
+    }
+    m_size = rhs.m_size;
+    m_arena = rhs.m_arena;
+    m_isValid = rhs.m_isValid;
+    m_readPos = rhs.m_readPos;
+
+    rhs.m_data = rhs.m_inline;
+    rhs.m_size = 0;
+    rhs.m_capacity = kInlineSize;
+    rhs.m_isValid = true;
+    rhs.m_readPos = 0;
+    return *this;
+}
+
 void Packet::append(const void* data, size_t sizeInBytes) {
     if (data && (sizeInBytes > 0)) {
-        size_t start = m_packetData.size();
-        m_packetData.resize(start + sizeInBytes);
-        std::memcpy(&m_packetData[start], data, sizeInBytes);
+        if (m_size + sizeInBytes > m_capacity) {
+            Grow(std::max(m_size + sizeInBytes, 2 * m_capacity));
+        }
+        std::memcpy(m_data + m_size, data, sizeInBytes);
+        m_size += sizeInBytes;
     }
 }
 
-void Packet::clear() { m_packetData.clear(); }
+template <class T>
+void Packet::appendArray(const T* data, size_t count) {
+    static_assert(sizeof(T) <= sizeof(uint32_t) ||
+                      std::is_floating_point_v<T>,
+                  "appendArray() supports integers of up to 32 bits, float, "
+                  "and double");
+
+    if (data == nullptr || count == 0) {
+        return;
+    }
+
+    size_t size = count * sizeof(T);
+    reserve(m_size + size);
+    char* out = m_data + m_size;
+    if constexpr (std::is_floating_point_v<T> || sizeof(T) == 1) {
+        // Written in host byte order like operator<<
+        std::memcpy(out, data, size);
+    } else {
+        // Simple enough for the compiler to vectorize the swaps
+        for (size_t i = 0; i < count; ++i) {
+            T value;
+            if constexpr (sizeof(T) == sizeof(uint16_t)) {
+                value = htons(data[i]);
+            } else {
+                value = htonl(data[i]);
+            }
+            std::memcpy(out + i * sizeof(T), &value, sizeof(T));
+        }
+    }
+    m_size += size;
+}
+
+template <class T>
+Packet& Packet::readArray(T* data, size_t count) {
+    PacketReader reader{m_data + m_readPos, m_size - m_readPos};
+    if (m_isValid && reader.ReadArray(data, count)) {
+        m_readPos += count * sizeof(T);
+    } else {
+        m_isValid = false;
+    }
+    return *this;
+}
+
+template void Packet::appendArray(const int8_t*, size_t);
+template void Packet::appendArray(const uint8_t*, size_t);
+template void Packet::appendArray(const int16_t*, size_t);
+template void Packet::appendArray(const uint16_t*, size_t);
+template void Packet::appendArray(const int32_t*, size_t);
+template void Packet::appendArray(const uint32_t*, size_t);
+template void Packet::appendArray(const float*, size_t);
+template void Packet::appendArray(const double*, size_t);
+
+template Packet& Packet::readArray(int8_t*, size_t);
+template Packet& Packet::readArray(uint8_t*, size_t);
+template Packet& Packet::readArray(int16_t*, size_t);
+template Packet& Packet::readArray(uint16_t*, size_t);
+template Packet& Packet::readArray(int32_t*, size_t);
+template Packet& Packet::readArray(uint32_t*, size_t);
+template Packet& Packet::readArray(float*, size_t);
+template Packet& Packet::readArray(double*, size_t);
+
+void Packet::reserve(size_t sizeInBytes) {
+    if (sizeInBytes > m_capacity) {
+        Grow(sizeInBytes);
+    }
+}
+
+void Packet::clear() { m_size = 0; }
 
 const void* Packet::getData() const {
-    if (!m_packetData.empty()) {
-        return &m_packetData[0];
+    if (m_size > 0) {
+        return m_data;
     } else {
         return nullptr;
     }
 }
 
-size_t Packet::getDataSize() const { return m_packetData.size(); }
+size_t Packet::getDataSize() const { return m_size; }
 
 Packet& Packet::operator>>(bool& data) {
     uint8_t value;
@@ -38,7 +157,7 @@ Packet& Packet::operator>>(bool& data) {
 
 Packet& Packet::operator>>(int8_t& data) {
     if (CheckSize(sizeof(data))) {
-        data = *reinterpret_cast<const int8_t*>(&m_packetData[m_readPos]);
+        data = *reinterpret_cast<const int8_t*>(&m_data[m_readPos]);
         m_readPos += sizeof(data);
     }
 
@@ -47,7 +166,7 @@ Packet& Packet::operator>>(int8_t& data) {
 
 Packet& Packet::operator>>(uint8_t& data) {
     if (CheckSize(sizeof(data))) {
-        data = *reinterpret_cast<const uint8_t*>(&m_packetData[m_readPos]);
+        data = *reinterpret_cast<const uint8_t*>(&m_data[m_readPos]);
         m_readPos += sizeof(data);
     }
 
@@ -57,7 +176,7 @@ Packet& Packet::operator>>(uint8_t& data) {
 Packet& Packet::operator>>(int16_t& data) {
     if (CheckSize(sizeof(data))) {
         data =
-            ntohs(*reinterpret_cast<const int16_t*>(&m_packetData[m_readPos]));
+            ntohs(*reinterpret_cast<const int16_t*>(&m_data[m_readPos]));
         m_readPos += sizeof(data);
     }
 
@@ -67,7 +186,7 @@ Packet& Packet::operator>>(int16_t& data) {
 Packet& Packet::operator>>(uint16_t& data) {
     if (CheckSize(sizeof(data))) {
         data =
-            ntohs(*reinterpret_cast<const uint16_t*>(&m_packetData[m_readPos]));
+            ntohs(*reinterpret_cast<const uint16_t*>(&m_data[m_readPos]));
         m_readPos += sizeof(data);
     }
 
@@ -77,7 +196,7 @@ Packet& Packet::operator>>(uint16_t& data) {
 Packet& Packet::operator>>(int32_t& data) {
     if (CheckSize(sizeof(data))) {
         data =
-            ntohl(*reinterpret_cast<const int32_t*>(&m_packetData[m_readPos]));
+            ntohl(*reinterpret_cast<const int32_t*>(&m_data[m_readPos]));
         m_readPos += sizeof(data);
     }
 
@@ -87,7 +206,7 @@ Packet& Packet::operator>>(int32_t& data) {
 Packet& Packet::operator>>(uint32_t& data) {
     if (CheckSize(sizeof(data))) {
         data =
-            ntohl(*reinterpret_cast<const uint32_t*>(&m_packetData[m_readPos]));
+            ntohl(*reinterpret_cast<const uint32_t*>(&m_data[m_readPos]));
         m_readPos += sizeof(data);
     }
 
@@ -96,7 +215,7 @@ Packet& Packet::operator>>(uint32_t& data) {
 
 Packet& Packet::operator>>(float& data) {
     if (CheckSize(sizeof(data))) {
-        data = *reinterpret_cast<const float*>(&m_packetData[m_readPos]);
+        data = *reinterpret_cast<const float*>(&m_data[m_readPos]);
         m_readPos += sizeof(data);
     }
 
@@ -105,7 +224,7 @@ Packet& Packet::operator>>(float& data) {
 
 Packet& Packet::operator>>(double& data) {
     if (CheckSize(sizeof(data))) {
-        data = *reinterpret_cast<const double*>(&m_packetData[m_readPos]);
+        data = *reinterpret_cast<const double*>(&m_data[m_readPos]);
         m_readPos += sizeof(data);
     }
 
@@ -120,7 +239,7 @@ Packet& Packet::operator>>(std::string& data) {
     data.clear();
     if ((length > 0) && CheckSize(length)) {
         // Then extract characters
-        data.assign(&m_packetData[m_readPos], length);
+        data.assign(&m_data[m_readPos], length);
 
         // Update reading position
         m_readPos += length;
@@ -191,8 +310,38 @@ Packet& Packet::operator<<(const std::string& data) {
     return *this;
 }
 
+Packet& Packet::operator<<(std::string_view data) {
+    // Written the same way as std::string
+    uint32_t length = static_cast<uint32_t>(data.size());
+    *this << length;
+
+    if (length > 0) {
+        append(data.data(), length);
+    }
+
+    return *this;
+}
+
 bool Packet::CheckSize(size_t size) {
-    m_isValid = m_isValid && (m_readPos + size <= m_packetData.size());
+    m_isValid = m_isValid && (m_readPos + size <= m_size);
 
     return m_isValid;
 }
+
+void Packet::Grow(size_t capacity) {
+    char* data = nullptr;
+    if (m_arena != nullptr) {
+        data = m_arena->Allocate(capacity);
+    }
+
+    std::unique_ptr<char[]> heap;
+    if (data == nullptr) {
+        heap = std::make_unique<char[]>(capacity);
+        data = heap.get();
+    }
+
+    std::memcpy(data, m_data, m_size);
+    m_data = data;
+    m_capacity = capacity;
+    m_heap = std::move(heap);
+}
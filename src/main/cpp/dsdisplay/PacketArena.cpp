@@ -0,0 +1,24 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include "dsdisplay/PacketArena.hpp"
+
+using namespace frc3512;
+
+PacketArena::PacketArena(size_t size)
+    : m_buffer{std::make_unique<char[]>(size)}, m_capacity{size} {}
+
+char* PacketArena::Allocate(size_t size) {
+    if (size > m_capacity - m_used) {
+        return nullptr;
+    }
+
+    char* block = m_buffer.get() + m_used;
+    m_used += size;
+    return block;
+}
+
+void PacketArena::Reset() { m_used = 0; }
+
+size_t PacketArena::Used() const { return m_used; }
+
+size_t PacketArena::Capacity() const { return m_capacity; }
@@ -0,0 +1,153 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include "dsdisplay/PacketReader.hpp"
+
+#include <arpa/inet.h>
+
+#include <cstring>
+#include <type_traits>
+
+#include "dsdisplay/Packet.hpp"
+
+using namespace frc3512;
+
+PacketReader::PacketReader(const char* data, size_t size)
+    : m_data{data}, m_size{data != nullptr ? size : 0} {}
+
+PacketReader::PacketReader(const Packet& packet)
+    : PacketReader(static_cast<const char*>(packet.getData()),
+                   packet.getDataSize()) {}
+
+PacketReader::operator bool() const { return m_isValid; }
+
+size_t PacketReader::Remaining() const { return m_size - m_readPos; }
+
+std::string_view PacketReader::ReadBytes(size_t size) {
+    if (!CheckSize(size)) {
+        return {};
+    }
+
+    std::string_view bytes{m_data + m_readPos, size};
+    m_readPos += size;
+    return bytes;
+}
+
+template <class T>
+bool PacketReader::ReadArray(T* data, size_t count) {
+    static_assert(sizeof(T) <= sizeof(uint32_t) ||
+                      std::is_floating_point_v<T>,
+                  "ReadArray() supports integers of up to 32 bits, float, "
+                  "and double");
+
+    // Checked by division so a huge count can't overflow the byte count
+    m_isValid = m_isValid && count <= Remaining() / sizeof(T);
+    if (!m_isValid) {
+        return false;
+    }
+    if (count == 0) {
+        return true;
+    }
+
+    const char* in = m_data + m_readPos;
+    if constexpr (std::is_floating_point_v<T> || sizeof(T) == 1) {
+        std::memcpy(data, in, count * sizeof(T));
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            T value;
+            std::memcpy(&value, in + i * sizeof(T), sizeof(T));
+            if constexpr (sizeof(T) == sizeof(uint16_t)) {
+                data[i] = ntohs(value);
+            } else {
+                data[i] = ntohl(value);
+            }
+        }
+    }
+    m_readPos += count * sizeof(T);
+    return true;
+}
+
+template bool PacketReader::ReadArray(int8_t*, size_t);
+template bool PacketReader::ReadArray(uint8_t*, size_t);
+template bool PacketReader::ReadArray(int16_t*, size_t);
+template bool PacketReader::ReadArray(uint16_t*, size_t);
+template bool PacketReader::ReadArray(int32_t*, size_t);
+template bool PacketReader::ReadArray(uint32_t*, size_t);
+template bool PacketReader::ReadArray(float*, size_t);
+template bool PacketReader::ReadArray(double*, size_t);
+
+PacketReader& PacketReader::operator>>(bool& data) {
+    uint8_t value;
+    if (ReadRaw(value)) {
+        data = value != 0;
+    }
+    return *this;
+}
+
+PacketReader& PacketReader::operator>>(int8_t& data) {
+    ReadRaw(data);
+    return *this;
+}
+
+PacketReader& PacketReader::operator>>(uint8_t& data) {
+    ReadRaw(data);
+    return *this;
+}
+
+PacketReader& PacketReader::operator>>(int16_t& data) {
+    uint16_t value;
+    if (ReadRaw(value)) {
+        data = static_cast<int16_t>(ntohs(value));
+    }
+    return *this;
+}
+
+PacketReader& PacketReader::operator>>(uint16_t& data) {
+    if (ReadRaw(data)) {
+        data = ntohs(data);
+    }
+    return *this;
+}
+
+PacketReader& PacketReader::operator>>(int32_t& data) {
+    uint32_t value;
+    if (ReadRaw(value)) {
+        data = static_cast<int32_t>(ntohl(value));
+    }
+    return *this;
+}
+
+PacketReader& PacketReader::operator>>(uint32_t& data) {
+    if (ReadRaw(data)) {
+        data = ntohl(data);
+    }
+    return *this;
+}
+
+PacketReader& PacketReader::operator>>(float& data) {
+    ReadRaw(data);
+    return *this;
+}
+
+PacketReader& PacketReader::operator>>(double& data) {
+    ReadRaw(data);
+    return *this;
+}
+
+PacketReader& PacketReader::operator>>(std::string_view& data) {
+    // First extract string length
+    uint32_t length = 0;
+    *this >> length;
+
+    // Then view the characters
+    if (CheckSize(length)) {
+        data = std::string_view{m_data + m_readPos, length};
+        m_readPos += length;
+    }
+    return *this;
+}
+
+bool PacketReader::CheckSize(size_t size) {
+    m_isValid = m_isValid && size <= m_size - m_readPos;
+
+    return m_isValid;
+}
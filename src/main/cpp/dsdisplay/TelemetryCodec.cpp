@@ -0,0 +1,196 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include "dsdisplay/TelemetryCodec.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace frc3512;
+
+namespace {
+
+constexpr uint8_t kKeyframeFlag = 1;
+
+// Header byte of a double that didn't change: eight leading zero bytes
+constexpr uint8_t kUnchanged = 8 << 4;
+
+// Maximum length of a 64-bit LEB128 varint
+constexpr size_t kMaxVarintSize = 10;
+
+uint64_t ZigZag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^
+           static_cast<uint64_t>(value >> 63);
+}
+
+int64_t UnZigZag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void AppendVarint(Packet& packet, uint64_t value) {
+    uint8_t buf[kMaxVarintSize];
+    size_t size = 0;
+    while (value >= 0x80) {
+        buf[size++] = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    buf[size++] = static_cast<uint8_t>(value);
+    packet.append(buf, size);
+}
+
+bool ReadVarint(PacketReader& reader, uint64_t& value) {
+    uint64_t result = 0;
+    for (size_t i = 0; i < kMaxVarintSize; ++i) {
+        uint8_t byte;
+        if (!reader.ReadRaw(byte)) {
+            return false;
+        }
+        result |= static_cast<uint64_t>(byte & 0x7f) << (7 * i);
+        if ((byte & 0x80) == 0) {
+            value = result;
+            return true;
+        }
+    }
+
+    // Too long to be a 64-bit varint
+    return false;
+}
+
+uint64_t DoubleBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+}  // namespace
+
+TelemetryEncoder::TelemetryEncoder(int keyframeInterval)
+    : m_keyframeInterval{std::max(keyframeInterval, 1)} {}
+
+void TelemetryEncoder::BeginFrame(Packet& packet) {
+    m_isKeyframe = m_framesUntilKeyframe == 0;
+    if (m_isKeyframe) {
+        m_framesUntilKeyframe = m_keyframeInterval;
+    }
+    --m_framesUntilKeyframe;
+    m_position = 0;
+
+    packet << static_cast<uint8_t>(m_isKeyframe ? kKeyframeFlag : 0);
+    AppendVarint(packet, m_sequence++);
+}
+
+void TelemetryEncoder::ForceKeyframe() { m_framesUntilKeyframe = 0; }
+
+void TelemetryEncoder::EncodeInteger(Packet& packet, int64_t value) {
+    auto bits = static_cast<uint64_t>(value);
+
+    // Subtracts as unsigned so it wraps instead of overflowing. The decoder
+    // adds it back the same way.
+    auto delta = static_cast<int64_t>(bits - Exchange(bits));
+    AppendVarint(packet, ZigZag(delta));
+}
+
+void TelemetryEncoder::EncodeDouble(Packet& packet, double value) {
+    uint64_t bits = DoubleBits(value);
+    uint64_t xored = bits ^ Exchange(bits);
+    if (xored == 0) {
+        packet << kUnchanged;
+        return;
+    }
+
+    int leading = __builtin_clzll(xored) / 8;
+    int trailing = __builtin_ctzll(xored) / 8;
+    uint8_t buf[1 + sizeof(uint64_t)];
+    buf[0] = static_cast<uint8_t>(leading << 4 | trailing);
+
+    // The bytes between the zeroes, most significant first
+    int size = 8 - leading - trailing;
+    for (int i = 0; i < size; ++i) {
+        buf[1 + i] = static_cast<uint8_t>(xored >> (8 * (7 - leading - i)));
+    }
+    packet.append(buf, 1 + size);
+}
+
+uint64_t TelemetryEncoder::Exchange(uint64_t value) {
+    if (m_position == m_previous.size()) {
+        m_previous.push_back(0);
+    }
+    uint64_t previous = m_isKeyframe ? 0 : m_previous[m_position];
+    m_previous[m_position++] = value;
+    return previous;
+}
+
+bool TelemetryDecoder::BeginFrame(PacketReader& reader) {
+    uint8_t flags;
+    uint64_t sequence;
+    if (!reader.ReadRaw(flags) || !ReadVarint(reader, sequence)) {
+        m_isSynced = false;
+        return false;
+    }
+
+    m_isKeyframe = (flags & kKeyframeFlag) != 0;
+    if (!m_isKeyframe && sequence != m_sequence + 1) {
+        m_isSynced = false;
+    } else if (m_isKeyframe) {
+        m_isSynced = true;
+    }
+    m_sequence = static_cast<uint32_t>(sequence);
+    m_position = 0;
+    return m_isSynced;
+}
+
+bool TelemetryDecoder::DecodeInteger(PacketReader& reader, int64_t& value) {
+    uint64_t zigzag;
+    if (!ReadVarint(reader, zigzag)) {
+        m_isSynced = false;
+        return false;
+    }
+
+    uint64_t decoded = Previous() + static_cast<uint64_t>(UnZigZag(zigzag));
+    Store(decoded);
+    value = static_cast<int64_t>(decoded);
+    return true;
+}
+
+bool TelemetryDecoder::DecodeDouble(PacketReader& reader, double& value) {
+    uint8_t header;
+    if (!reader.ReadRaw(header)) {
+        m_isSynced = false;
+        return false;
+    }
+
+    int leading = header >> 4;
+    int trailing = header & 0xf;
+    int size = 8 - leading - trailing;
+    if (size < 0) {
+        m_isSynced = false;
+        return false;
+    }
+
+    std::string_view bytes = reader.ReadBytes(size);
+    if (!reader) {
+        m_isSynced = false;
+        return false;
+    }
+
+    uint64_t xored = 0;
+    for (int i = 0; i < size; ++i) {
+        xored |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[i]))
+                 << (8 * (7 - leading - i));
+    }
+
+    uint64_t bits = Previous() ^ xored;
+    Store(bits);
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+uint64_t TelemetryDecoder::Previous() {
+    if (m_position == m_previous.size()) {
+        m_previous.push_back(0);
+    }
+    return m_isKeyframe ? 0 : m_previous[m_position];
+}
+
+void TelemetryDecoder::Store(uint64_t value) {
+    m_previous[m_position++] = value;
+}
@@ -135,6 +135,8 @@ void UdpSocket::setBlocking(bool blocking) {
 
 bool UdpSocket::isBlocking() const { return m_isBlocking; }
 
+int UdpSocket::getHandle() const { return m_socket; }
+
 void UdpSocket::create() {
     // Don't create the socket if it already exists
     if (m_socket == -1) {
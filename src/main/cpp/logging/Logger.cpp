@@ -1,8 +1,9 @@
-// Copyright (c) 2014-2019 FRC Team 3512. All Rights Reserved.
+// Copyright (c) 2014-2020 FRC Team 3512. All Rights Reserved.
 
 #include "logging/Logger.hpp"
 
 #include <algorithm>
+#include <mutex>
 
 using namespace frc3512;
 
@@ -11,6 +12,7 @@ Logger::Logger() : Logger::PublishNode("Logger") { ResetInitialTime(); }
 void Logger::Log(LogEvent event) {
     event.SetInitialTime(m_initialTime);
 
+    std::lock_guard lock(m_sinkMutex);
     for (auto sink : m_sinkList) {
         if (sink.get().TestVerbosityLevel(event.GetVerbosityLevel())) {
             sink.get().Log(event);
@@ -18,9 +20,17 @@ void Logger::Log(LogEvent event) {
     }
 }
 
-void Logger::AddLogSink(LogSinkBase& sink) { m_sinkList.emplace_back(sink); }
+void Logger::LogNodeStats(const NodeStatsSnapshot& stats) {
+    Log(LogEvent("NodeStats " + stats.ToString(), LogEvent::VERBOSE_INFO));
+}
+
+void Logger::AddLogSink(LogSinkBase& sink) {
+    std::lock_guard lock(m_sinkMutex);
+    m_sinkList.emplace_back(sink);
+}
 
 void Logger::RemoveLogSink(LogSinkBase& sink) {
+    std::lock_guard lock(m_sinkMutex);
     m_sinkList.erase(
         std::remove_if(m_sinkList.begin(), m_sinkList.end(),
                        [&](std::reference_wrapper<LogSinkBase> elem) -> bool {
@@ -29,34 +39,37 @@ void Logger::RemoveLogSink(LogSinkBase& sink) {
         m_sinkList.end());
 }
 
-Logger::LogSinkBaseList Logger::ListLogSinks() const { return m_sinkList; }
+Logger::LogSinkBaseList Logger::ListLogSinks() const {
+    std::lock_guard lock(m_sinkMutex);
+    return m_sinkList;
+}
 
 void Logger::ResetInitialTime() { m_initialTime = std::time(nullptr); }
 
 void Logger::SetInitialTime(std::time_t time) { m_initialTime = time; }
 
 void Logger::ProcessMessage(const StatePacket& message) {
-    Log(LogEvent(
-        "StatePacket (" + message.topic + "): " + std::to_string(message.state),
-        LogEvent::VERBOSE_DEBUG));
+    Log(LogEvent("StatePacket (" + std::string{message.topic} +
+                     "): " + std::to_string(message.state),
+                 LogEvent::VERBOSE_DEBUG));
 }
 
 void Logger::ProcessMessage(const ButtonPacket& message) {
     if (message.pressed) {
-        Log(LogEvent("ButtonPacket (" + message.topic +
+        Log(LogEvent("ButtonPacket (" + std::string{message.topic} +
                          "): " + std::to_string(message.button) + " Pressed",
                      LogEvent::VERBOSE_DEBUG));
     } else {
-        Log(LogEvent("ButtonPacket (" + message.topic +
+        Log(LogEvent("ButtonPacket (" + std::string{message.topic} +
                          "): " + std::to_string(message.button) + " Released",
                      LogEvent::VERBOSE_DEBUG));
     }
 }
 
 void Logger::ProcessMessage(const CommandPacket& message) {
-    if (message.topic == "Robot/TeleopInit" && !message.reply) {
+    if (message.topicID == "Robot/TeleopInit"_topic && !message.reply) {
         EnablePeriodic();
     }
-    Log(LogEvent("CommandPacket (" + message.topic + ")",
+    Log(LogEvent("CommandPacket (" + std::string{message.topic} + ")",
                  LogEvent::VERBOSE_DEBUG));
 }
@@ -10,15 +10,31 @@
 using namespace frc3512;
 using namespace frc3512::Constants::Climber;
 
+namespace {
+
+// The Elevator must be above these heights in meters before the FourBarLift
+// lowers
+constexpr double kThirdLevelMinHeight = 0.3;
+constexpr double kSecondLevelMinHeight = 0.1;
+
+// The FourBarLift must be below this angle in radians before the climber
+// lowers
+constexpr double kFourBarMaxAngle = -0.7;
+
+}  // namespace
+
 Climber::Climber(frc::PowerDistributionPanel& pdp)
     : PublishNode("Climber"), m_pdp(pdp) {
     m_encoder.SetReverseDirection(true);
     m_encoder.SetDistancePerPulse(kDpP);
     m_lift.SetInverted(true);
     m_timer.Start();
-    Subscribe(*this);
+    Subscribe(*this, {PacketType::kCommand});
 }
 
+// Request callbacks use the state machine's members
+Climber::~Climber() { Stop(); }
+
 void Climber::SetDriveVoltage(double voltage) { m_drive.Set(voltage); }
 
 void Climber::SetVoltage(double voltage) { m_lift.Set(voltage); }
@@ -56,93 +72,72 @@ bool Climber::AtReference() const { return m_controller.AtReferences(); }
 
 double Climber::ControllerVoltage() { return m_controller.ControllerVoltage(); }
 
+void Climber::SetGoalTimeout(std::chrono::nanoseconds timeout) {
+    m_goalTimeout = timeout;
+}
+
+State Climber::GetState() const { return m_state; }
+
 void Climber::Reset() {
     ResetEncoder();
     m_controller.Reset();
 }
 
 void Climber::SubsystemPeriodic() {
+    auto& blackboard = Blackboard::GetInstance();
+
     switch (m_state) {
         case State::kInit: {
-            std::lock_guard lock(m_cacheMutex);
-            if (m_buttonPacket.topic == "Robot/AppendageStick2" &&
-                m_buttonPacket.button == 7 && m_buttonPacket.pressed) {
-                m_buttonPacket.pressed = false;
+            if (ConsumeButtonPress(7)) {
                 m_thirdLevel = true;
-                CommandPacket message{"ThirdLevel", true};
-                Publish(message);
                 m_state = State::kThirdLevel;
+                Request(CommandPacket{"ThirdLevel", false, 0}, m_goalTimeout,
+                        [this](const CommandPacket* reply) {
+                            OnElevatorRaised(reply);
+                        });
             }
-            if (m_buttonPacket.topic == "Robot/AppendageStick2" &&
-                m_buttonPacket.button == 8 && m_buttonPacket.pressed) {
-                m_buttonPacket.pressed = false;
+            if (ConsumeButtonPress(8)) {
                 m_thirdLevel = false;
-                CommandPacket message{"SecondLevel", true};
-                Publish(message);
                 m_state = State::kSecondLevel;
+                Request(CommandPacket{"SecondLevel", false, 0}, m_goalTimeout,
+                        [this](const CommandPacket* reply) {
+                            OnElevatorRaised(reply);
+                        });
             }
             break;
         }
         case State::kThirdLevel: {
-            std::lock_guard lock(m_cacheMutex);
             wpi::outs() << "ThirdLevel\n";
-            if (m_elevatorStatusPacket.atGoal &&
-                m_elevatorStatusPacket.distance > 0.3) {
-                CommandPacket message0{"FourBarStart", true};
-                Publish(message0);
-                m_state = State::kFourBarDescend;
-            }
             break;
         }
         case State::kSecondLevel: {
-            std::lock_guard lock(m_cacheMutex);
             wpi::outs() << "SecondLevel\n";
-            if (m_elevatorStatusPacket.atGoal &&
-                m_elevatorStatusPacket.distance > 0.1) {
-                CommandPacket message0{"FourBarStart", true};
-                Publish(message0);
-                m_state = State::kFourBarDescend;
-            }
             break;
         }
-        case State::kFourBarDescend: {
-            std::lock_guard lock(m_cacheMutex);
-            if (m_fourBarLiftStatusPacket.atGoal &&
-                m_fourBarLiftStatusPacket.distance < -0.7) {
-                CommandPacket message1{"ClimbingProfile", false};
-                Publish(message1);
-                if (m_thirdLevel) {
-                    CommandPacket message2{"Down3", false};
-                    Publish(message2);
-                } else {
-                    CommandPacket message2{"Down2", false};
-                    Publish(message2);
-                }
-                m_state = State::kDescend;
-            }
+        case State::kFourBarDescend:
+            // Waiting for FourBarLift's reply
             break;
-        }
         case State::kDescend: {
-            std::lock_guard lock(m_cacheMutex);
-            if (m_controller.AtGoal() && m_elevatorStatusPacket.atGoal) {
+            ElevatorStatusPacket elevatorStatus;
+            if (blackboard.Read("Elevator/Status"_topic, elevatorStatus) &&
+                m_controller.AtGoal() && elevatorStatus.atGoal) {
                 m_state = State::kDriveForward;
             }
             break;
         }
         case State::kDriveForward: {
-            std::lock_guard lock(m_cacheMutex);
-            m_drive.Set(-m_HIDPacket.y1);
-            if (m_buttonPacket.topic == "Robot/AppendageStick2" &&
-                m_buttonPacket.button == 9 && m_buttonPacket.pressed) {
-                m_buttonPacket.pressed = false;
-                CommandPacket message{"Up", false};
+            HIDPacket hid;
+            blackboard.Read("Robot/HID"_topic, hid);
+            m_drive.Set(-hid.y[0]);
+            if (ConsumeButtonPress(9)) {
+                CommandPacket message{"Up", false, 0};
                 Publish(message);
                 m_state = State::kIdle;
             }
             break;
         }
         case State::kIdle: {
-            CommandPacket message{"ScoringProfile", false};
+            CommandPacket message{"ScoringProfile", false, 0};
             Publish(message);
             break;
         }
@@ -150,50 +145,85 @@ void Climber::SubsystemPeriodic() {
 }
 
 void Climber::ProcessMessage(const ButtonPacket& message) {
-    if (message.topic == "Robot/AppendageStick2" && message.button == 7 &&
-        message.pressed) {
-        std::lock_guard lock(m_cacheMutex);
-        m_buttonPacket = message;
-    } else if (message.topic == "Robot/AppendageStick2" &&
-               message.button == 8 && message.pressed) {
-        std::lock_guard lock(m_cacheMutex);
-        m_buttonPacket = message;
-    } else if (message.topic == "Robot/AppendageStick2" &&
-               message.button == 9 && message.pressed) {
-        std::lock_guard lock(m_cacheMutex);
-        m_buttonPacket = message;
+    if (message.topicID == "Robot/AppendageStick2"_topic && message.pressed &&
+        (message.button == 7 || message.button == 8 || message.button == 9)) {
+        m_pressedButton = message.button;
     }
 }
 
 void Climber::ProcessMessage(const CommandPacket& message) {
-    if (message.topic == "Robot/AutonomousInit") {
-        EnablePeriodic();
-        Enable();
-        SetGoal(0.02);
-    } else if (message.topic == "Robot/TeleopInit") {
-        EnablePeriodic();
-        Enable();
-        SetGoal(0.02);
-    } else if (message.topic == "Climber/Down3") {
-        SetGoal(kClimb3Height);
-    } else if (message.topic == "Climber/Down2") {
-        SetGoal(kClimb2Height);
-    } else if (message.topic == "Climber/Up") {
-        SetGoal(0);
+    switch (message.topicID) {
+        case "Robot/AutonomousInit"_topic:
+        case "Robot/TeleopInit"_topic:
+            EnablePeriodic();
+            Enable();
+            SetGoal(0.02);
+            break;
+        case "Climber/Down3"_topic:
+            SetGoal(kClimb3Height);
+            break;
+        case "Climber/Down2"_topic:
+            SetGoal(kClimb2Height);
+            break;
+        case "Climber/Up"_topic:
+            SetGoal(0);
+            break;
     }
 }
 
-void Climber::ProcessMessage(const HIDPacket& message) {
-    std::lock_guard lock(m_cacheMutex);
-    m_HIDPacket = message;
+void Climber::OnElevatorRaised(const CommandPacket* reply) {
+    if (reply == nullptr) {
+        wpi::outs() << "Climber: Elevator didn't reach climbing height\n";
+        m_state = State::kInit;
+        return;
+    }
+
+    // The Elevator publishes its status before replying, so the Blackboard
+    // holds the height the goal was reached at
+    ElevatorStatusPacket status;
+    double minHeight =
+        m_thirdLevel ? kThirdLevelMinHeight : kSecondLevelMinHeight;
+    if (!Blackboard::GetInstance().Read("Elevator/Status"_topic, status) ||
+        status.distance <= minHeight) {
+        wpi::outs() << "Climber: Elevator stopped below climbing height\n";
+        m_state = State::kInit;
+        return;
+    }
+
+    m_state = State::kFourBarDescend;
+    Request(
+        CommandPacket{"FourBarStart", false, 0}, m_goalTimeout,
+        [this](const CommandPacket* reply) { OnFourBarLowered(reply); });
 }
 
-void Climber::ProcessMessage(const ElevatorStatusPacket& message) {
-    std::lock_guard lock(m_cacheMutex);
-    m_elevatorStatusPacket = message;
+void Climber::OnFourBarLowered(const CommandPacket* reply) {
+    if (reply == nullptr) {
+        wpi::outs() << "Climber: FourBarLift didn't reach climbing angle\n";
+        m_state = State::kInit;
+        return;
+    }
+
+    FourBarLiftStatusPacket status;
+    if (!Blackboard::GetInstance().Read("FourBarLift/Status"_topic, status) ||
+        status.distance >= kFourBarMaxAngle) {
+        wpi::outs() << "Climber: FourBarLift stopped above climbing angle\n";
+        m_state = State::kInit;
+        return;
+    }
+
+    CommandPacket message1{"ClimbingProfile", false, 0};
+    Publish(message1);
+    if (m_thirdLevel) {
+        CommandPacket message2{"Down3", false, 0};
+        Publish(message2);
+    } else {
+        CommandPacket message2{"Down2", false, 0};
+        Publish(message2);
+    }
+    m_state = State::kDescend;
 }
 
-void Climber::ProcessMessage(const FourBarLiftStatusPacket& message) {
-    std::lock_guard lock(m_cacheMutex);
-    m_fourBarLiftStatusPacket = message;
+bool Climber::ConsumeButtonPress(int button) {
+    int pressed = button;
+    return m_pressedButton.compare_exchange_strong(pressed, 0);
 }
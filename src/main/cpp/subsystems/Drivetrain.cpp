@@ -122,33 +122,39 @@ void Drivetrain::SetWaypoints(const std::vector<frc::Pose2d>& waypoints) {
 }
 
 void Drivetrain::ProcessMessage(const ButtonPacket& message) {
-    if (message.topic == "Robot/DriveStick2" && message.button == 1 &&
+    if (message.topicID == "Robot/DriveStick2"_topic && message.button == 1 &&
         message.pressed) {
         Shift();
     }
 }
 
 void Drivetrain::ProcessMessage(const CommandPacket& message) {
-    if (message.topic == "Robot/DisabledInit" && !message.reply) {
-        DisableController();
+    if (message.reply) {
+        return;
     }
-    if (message.topic == "Robot/AutonomousInit" && !message.reply) {
-        Reset();
-        EnableController();
-        m_startTime = std::chrono::steady_clock::now();
-    }
-    if (message.topic == "Robot/TeleopInit" && !message.reply) {
-        EnablePeriodic();
+
+    switch (message.topicID) {
+        case "Robot/DisabledInit"_topic:
+            DisableController();
+            break;
+        case "Robot/AutonomousInit"_topic:
+            Reset();
+            EnableController();
+            m_startTime = std::chrono::steady_clock::now();
+            break;
+        case "Robot/TeleopInit"_topic:
+            EnablePeriodic();
+            break;
     }
 }
 
 void Drivetrain::ProcessMessage(const HIDPacket& message) {
     if (!IsControllerEnabled()) {
         if (GetRawButton(message, 0, 1)) {
-            Drive(-message.y1 * 0.5, message.x2 * 0.5,
+            Drive(-message.y[0] * 0.5, message.x[1] * 0.5,
                   GetRawButton(message, 1, 2));
         } else {
-            Drive(-message.y1, message.x2, GetRawButton(message, 1, 2));
+            Drive(-message.y[0], message.x[1], GetRawButton(message, 1, 2));
         }
     }
 }
@@ -41,7 +41,12 @@ void Elevator::SetScoringIndex() { m_controller.SetScoringIndex(); }
 
 void Elevator::SetClimbingIndex() { m_controller.SetClimbingIndex(); }
 
-void Elevator::SetGoal(double position) { m_controller.SetGoal(position); }
+void Elevator::SetGoal(double position) {
+    // A new goal supersedes the one a pending request asked for
+    m_goalRequestID = 0;
+    m_isGoalReached = false;
+    m_controller.SetGoal(position);
+}
 
 bool Elevator::AtReference() const { return m_controller.AtReferences(); }
 
@@ -55,6 +60,12 @@ void Elevator::Iterate() {
     double batteryVoltage =
         frc::DriverStation::GetInstance().GetBatteryVoltage();
     m_grbx.Set(m_controller.ControllerVoltage() / batteryVoltage);
+
+    // Publishing can block, so the control loop only flags a reached goal.
+    // SubsystemPeriodic() hands it to the node's thread, which replies.
+    if (m_goalRequestID != 0 && m_controller.AtGoal()) {
+        m_isGoalReached = true;
+    }
 }
 
 double Elevator::ControllerVoltage() const {
@@ -68,56 +79,85 @@ void Elevator::Reset() {
 
 void Elevator::SubsystemPeriodic() {
     ElevatorStatusPacket message{
-        "", m_encoder.GetDistance(), m_controller.ControllerVoltage(),
+        "Status", m_encoder.GetDistance(), m_controller.ControllerVoltage(),
         m_controller.AtReferences(), m_controller.AtGoal()};
     Publish(message);
+
+    if (m_isGoalReached.exchange(false)) {
+        PushMessage(CommandPacket{"GoalReached", false, m_goalRequestID});
+    }
 }
 
 void Elevator::ProcessMessage(const ButtonPacket& message) {
-    if (message.topic == "Robot/AppendageStick2" && message.button == 3 &&
-        message.pressed) {
-        SetGoal(kFloorHeight);
-    } else if (message.topic == "Robot/AppendageStick" &&
-               message.button == 11 && message.pressed) {
-        SetGoal(kBottomHatch);
-    } else if (message.topic == "Robot/AppendageStick" &&
-               message.button == 12 && message.pressed) {
-        SetGoal(kBottomCargo);
-    } else if (message.topic == "Robot/AppendageStick" && message.button == 9 &&
-               message.pressed) {
-        SetGoal(kMiddleHatch);
-    } else if (message.topic == "Robot/AppendageStick" &&
-               message.button == 10 && message.pressed) {
-        SetGoal(kMiddleCargo);
-    } else if (message.topic == "Robot/AppendageStick" && message.button == 7 &&
-               message.pressed) {
-        SetGoal(kTopHatch);
-    } else if (message.topic == "Robot/AppendageStick" && message.button == 8 &&
-               message.pressed) {
-        SetGoal(kTopCargo);
-    } else if (message.topic == "Robot/AppendageStick2" &&
-               message.button == 2 && message.pressed) {
-        SetGoal(kCargoShip);
+    if (!message.pressed) {
+        return;
+    }
+
+    switch (message.topicID) {
+        case "Robot/AppendageStick2"_topic:
+            if (message.button == 3) {
+                SetGoal(kFloorHeight);
+            } else if (message.button == 2) {
+                SetGoal(kCargoShip);
+            }
+            break;
+        case "Robot/AppendageStick"_topic:
+            if (message.button == 11) {
+                SetGoal(kBottomHatch);
+            } else if (message.button == 12) {
+                SetGoal(kBottomCargo);
+            } else if (message.button == 9) {
+                SetGoal(kMiddleHatch);
+            } else if (message.button == 10) {
+                SetGoal(kMiddleCargo);
+            } else if (message.button == 7) {
+                SetGoal(kTopHatch);
+            } else if (message.button == 8) {
+                SetGoal(kTopCargo);
+            }
+            break;
     }
 }
 
 void Elevator::ProcessMessage(const CommandPacket& message) {
-    if (message.topic == "Robot/TeleopInit" && !message.reply) {
-        Enable();
-    } else if (message.topic == "Robot/AutonomousInit" && !message.reply) {
-        Enable();
-    } else if (message.topic == "Robot/DisabledInit" && !message.reply) {
-        Disable();
-    } else if (message.topic == "Climber/ThirdLevel") {
-        SetGoal(kHab3);
-    } else if (message.topic == "Climber/SecondLevel") {
-        SetGoal(kHab2);
-    } else if (message.topic == "Climber/ClimbingProfile") {
-        m_controller.SetClimbingIndex();
-    } else if (message.topic == "Climber/Down3" ||
-               message.topic == "Climber/Down2") {
-        SetGoal(0);
-    } else if (message.topic == "Climber/ScoringProfile") {
-        m_controller.SetScoringIndex();
+    switch (message.topicID) {
+        case "Robot/TeleopInit"_topic:
+        case "Robot/AutonomousInit"_topic:
+            if (!message.reply) {
+                Enable();
+            }
+            break;
+        case "Robot/DisabledInit"_topic:
+            if (!message.reply) {
+                Disable();
+            }
+            break;
+        case "Climber/ThirdLevel"_topic:
+            SetGoal(kHab3);
+            m_goalRequestID = message.requestID;
+            break;
+        case "GoalReached"_topic: {
+            // Dropped if a new goal replaced the one that was reached
+            uint32_t requestID = message.requestID;
+            if (requestID != 0 && m_controller.AtGoal() &&
+                m_goalRequestID.compare_exchange_strong(requestID, 0)) {
+                Reply(requestID);
+            }
+            break;
+        }
+        case "Climber/SecondLevel"_topic:
+            SetGoal(kHab2);
+            m_goalRequestID = message.requestID;
+            break;
+        case "Climber/ClimbingProfile"_topic:
+            m_controller.SetClimbingIndex();
+            break;
+        case "Climber/Down3"_topic:
+        case "Climber/Down2"_topic:
+            SetGoal(0);
+            break;
+        case "Climber/ScoringProfile"_topic:
+            m_controller.SetScoringIndex();
+            break;
     }
 }
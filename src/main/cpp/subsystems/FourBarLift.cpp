@@ -35,7 +35,12 @@ void FourBarLift::Disable() {
     m_thread.Stop();
 }
 
-void FourBarLift::SetGoal(double position) { m_controller.SetGoal(position); }
+void FourBarLift::SetGoal(double position) {
+    // A new goal supersedes the one a pending request asked for
+    m_goalRequestID = 0;
+    m_isGoalReached = false;
+    m_controller.SetGoal(position);
+}
 
 bool FourBarLift::AtReference() const { return m_controller.AtReferences(); }
 
@@ -49,6 +54,12 @@ void FourBarLift::Iterate() {
     double batteryVoltage =
         frc::DriverStation::GetInstance().GetBatteryVoltage();
     m_grbx.Set(m_controller.ControllerVoltage() / batteryVoltage);
+
+    // Publishing can block, so the control loop only flags a reached goal.
+    // SubsystemPeriodic() hands it to the node's thread, which replies.
+    if (m_goalRequestID != 0 && m_controller.AtGoal()) {
+        m_isGoalReached = true;
+    }
 }
 
 void FourBarLift::Reset() {
@@ -58,48 +69,75 @@ void FourBarLift::Reset() {
 
 void FourBarLift::SubsystemPeriodic() {
     FourBarLiftStatusPacket message{
-        "", m_encoder.GetDistance(), m_controller.ControllerVoltage(),
+        "Status", m_encoder.GetDistance(), m_controller.ControllerVoltage(),
         m_controller.AtReferences(), m_controller.AtGoal()};
     Publish(message);
+
+    if (m_isGoalReached.exchange(false)) {
+        PushMessage(CommandPacket{"GoalReached", false, m_goalRequestID});
+    }
 }
 
 void FourBarLift::ProcessMessage(const ButtonPacket& message) {
-    if (message.topic == "Robot/AppendageStick2" && message.button == 3 &&
-        message.pressed) {
-        SetGoal(kMin);
-    } else if (message.topic == "Robot/AppendageStick2" &&
-               message.button == 2 && message.pressed) {
-        SetGoal(kMax);
-    } else if (message.topic == "Robot/AppendageStick" &&
-               message.button == 11 && message.pressed) {
-        SetGoal(kBottomHatch);
-    } else if (message.topic == "Robot/DriveStick2" && message.button == 7 &&
-               message.pressed) {
-        m_controller.SetClimbing(true);
-    } else if (message.topic == "Robot/DriveStick2" && message.button == 8 &&
-               message.pressed) {
-        m_controller.SetClimbing(false);
-    } else if (message.topic == "Robot/AppendageStick" && message.pressed) {
-        if (message.button == 12 || message.button == 9 ||
-            message.button == 10 || message.button == 7 ||
-            message.button == 8) {
-            SetGoal(kMax);
-        }
+    switch (message.topicID) {
+        case "Robot/AppendageStick2"_topic:
+            if (message.button == 3 && message.pressed) {
+                SetGoal(kMin);
+            } else if (message.button == 2 && message.pressed) {
+                SetGoal(kMax);
+            }
+            break;
+        case "Robot/AppendageStick"_topic:
+            if (message.button == 11 && message.pressed) {
+                SetGoal(kBottomHatch);
+            } else if (message.pressed) {
+                if (message.button == 12 || message.button == 9 ||
+                    message.button == 10 || message.button == 7 ||
+                    message.button == 8) {
+                    SetGoal(kMax);
+                }
+            }
+            break;
+        case "Robot/DriveStick2"_topic:
+            if (message.button == 7 && message.pressed) {
+                m_controller.SetClimbing(true);
+            } else if (message.button == 8 && message.pressed) {
+                m_controller.SetClimbing(false);
+            }
+            break;
     }
 }
 
 void FourBarLift::ProcessMessage(const CommandPacket& message) {
-    if (message.topic == "Robot/TeleopInit" && !message.reply) {
-        Enable();
-    } else if (message.topic == "Robot/AutonomousInit" && !message.reply) {
-        Enable();
-    } else if (message.topic == "Robot/DisabledInit" && !message.reply) {
-        Disable();
-    } else if (message.topic == "Climber/FourBarStart") {
-        m_controller.SetClimbing(true);
-        SetGoal(-1.35);
-    } else if (message.topic == "Climber/Up") {
-        m_controller.SetClimbing(false);
-        SetGoal(0);
+    switch (message.topicID) {
+        case "Robot/TeleopInit"_topic:
+        case "Robot/AutonomousInit"_topic:
+            if (!message.reply) {
+                Enable();
+            }
+            break;
+        case "Robot/DisabledInit"_topic:
+            if (!message.reply) {
+                Disable();
+            }
+            break;
+        case "Climber/FourBarStart"_topic:
+            m_controller.SetClimbing(true);
+            SetGoal(-1.35);
+            m_goalRequestID = message.requestID;
+            break;
+        case "GoalReached"_topic: {
+            // Dropped if a new goal replaced the one that was reached
+            uint32_t requestID = message.requestID;
+            if (requestID != 0 && m_controller.AtGoal() &&
+                m_goalRequestID.compare_exchange_strong(requestID, 0)) {
+                Reply(requestID);
+            }
+            break;
+        }
+        case "Climber/Up"_topic:
+            m_controller.SetClimbing(false);
+            SetGoal(0);
+            break;
     }
 }
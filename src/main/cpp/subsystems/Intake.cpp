@@ -23,20 +23,19 @@ void Intake::SetMotors(MotorState motorState) {
 void Intake::ToggleClaw() { m_claw.Set(!m_claw.Get()); }
 
 void Intake::ProcessMessage(const ButtonPacket& message) {
-    if (message.topic == "Robot/AppendageStick2" && message.button == 4 &&
-        message.pressed) {
+    if (message.topicID != "Robot/AppendageStick2"_topic) {
+        return;
+    }
+
+    if (message.button == 4 && message.pressed) {
         SetMotors(MotorState::kOuttake);
-    } else if (message.topic == "Robot/AppendageStick2" &&
-               message.button == 6 && message.pressed) {
+    } else if (message.button == 6 && message.pressed) {
         SetMotors(MotorState::kIntake);
-    } else if (message.topic == "Robot/AppendageStick2" &&
-               message.button == 4 && !message.pressed) {
+    } else if (message.button == 4 && !message.pressed) {
         SetMotors(MotorState::kIdle);
-    } else if (message.topic == "Robot/AppendageStick2" &&
-               message.button == 6 && !message.pressed) {
+    } else if (message.button == 6 && !message.pressed) {
         SetMotors(MotorState::kIdle);
-    } else if (message.topic == "Robot/AppendageStick2" &&
-               message.button == 1 && message.pressed) {
+    } else if (message.button == 1 && message.pressed) {
         ToggleClaw();
     }  // TODO get state and put in DS
 }
@@ -15,6 +15,13 @@ constexpr double kGravity = 9.80665;
 namespace Robot {
 constexpr int kMjpegServerPort = 1180;
 
+// Shared memory ring tools outside the robot program read telemetry from
+constexpr char kTelemetryShmName[] = "/frc3512-telemetry";
+
+// Number of traffic recordings kept in the operating directory. Older ones are
+// deleted when a new one starts.
+constexpr int kMaxRecordings = 10;
+
 /*
  * Joystick and buttons
  */
@@ -1,4 +1,4 @@
-// Copyright (c) 2019 FRC Team 3512. All Rights Reserved.
+// Copyright (c) 2019-2020 FRC Team 3512. All Rights Reserved.
 
 #pragma once
 
@@ -36,7 +36,28 @@ public:
     void AutonomousPeriodic() override;
     void TeleopPeriodic() override;
 
+    /**
+     * Logs every node's PublishNode statistics and writes them to
+     * NodeStats.csv in the operating directory, replacing the previous file.
+     * The delivery latency of each subscription is written to NodeEdges.csv.
+     */
+    void ExportNodeStats();
+
+    /**
+     * Starts recording all PublishNode traffic to Traffic-0.rec in the
+     * operating directory, which Replayer can replay offline. Recording stops
+     * in DisabledInit(). If a recording is already running, such as when
+     * teleop follows autonomous, it continues instead.
+     *
+     * Previous recordings are renamed to Traffic-1.rec and so on, and only the
+     * newest kMaxRecordings are kept so they don't fill the roboRIO's flash.
+     */
+    void StartRecording();
+
 private:
+    // Declared before the nodes which publish into it so it outlives them
+    ShmWriter m_telemetry{kTelemetryShmName};
+
     frc::PowerDistributionPanel m_pdp;
     Climber m_climber{m_pdp};
     Drivetrain m_drivetrain;
@@ -0,0 +1,113 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+
+#include "communications/Message.hpp"
+#include "communications/Topic.hpp"
+
+namespace frc3512 {
+
+/**
+ * Holds the latest packet published on each topic.
+ *
+ * PublishNode::Publish() writes every packet here, so any subsystem can read
+ * another's most recent status without subscribing to it or caching it behind
+ * a mutex.
+ *
+ * Each topic's slot is a seqlock. A reader copies the slot and retries if a
+ * write overlapped the copy, so reads never block the publisher and always
+ * return a packet that was written in full. Writes never wait, so each topic
+ * may only be written by one thread at a time. Publish() qualifies topics
+ * with the node's name, so this holds as long as a node publishes each of
+ * its topics from one thread.
+ *
+ * Only the words the packet itself occupies are copied, not a whole
+ * Message. They're copied through atomics, which is why packets must be
+ * trivially copyable. Publish() skips packets that aren't, such as ones with
+ * string fields.
+ *
+ * Usage:
+ * ElevatorStatusPacket status;
+ * if (Blackboard::GetInstance().Read("Elevator/Status"_topic, status)) { ... }
+ */
+class Blackboard {
+public:
+    /**
+     * Maximum number of distinct topics.
+     */
+    static constexpr size_t kMaxTopics = TopicRegistry::kMaxTopics;
+
+    static Blackboard& GetInstance();
+
+    /**
+     * Replaces the latest packet on the packet's topic.
+     *
+     * This is wait-free. Only one thread may write a given topic at a time;
+     * concurrent writes to the same topic can tear.
+     *
+     * @param p Any packet type held by Message with its topicID set.
+     */
+    template <class P>
+    void Write(const P& p);
+
+    /**
+     * Copies the latest packet on the given topic.
+     *
+     * @param topicID The topic's ID.
+     * @param p       Destination of the packet.
+     * @return False if nothing was written to the topic or the latest packet
+     *         isn't of type P.
+     */
+    template <class P>
+    bool Read(TopicID topicID, P& p) const;
+
+private:
+    static constexpr size_t kCacheLineSize = 64;
+
+    // Number of words a packet of type P occupies
+    template <class P>
+    static constexpr size_t kWordsOf =
+        (sizeof(P) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    // Words in a slot, enough for the largest packet type
+    static constexpr size_t kNumWords = kWordsOf<Message>;
+
+    struct alignas(kCacheLineSize) Slot {
+        std::atomic<TopicID> topicID{0};
+
+        // Odd while a write is in progress, zero if never written. Only the
+        // topic's writer changes it.
+        std::atomic<uint32_t> sequence{0};
+
+        // The packet's PacketType and bytes, guarded by the sequence
+        std::atomic<int8_t> type{0};
+        std::array<std::atomic<uint64_t>, kNumWords> words{};
+    };
+
+    std::array<Slot, kMaxTopics> m_slots;
+
+    Blackboard() = default;
+
+    /**
+     * Returns the slot for the given topic, claiming a free one if the topic
+     * doesn't have one yet.
+     *
+     * @return The slot, or nullptr if every slot belongs to another topic.
+     */
+    Slot* ClaimSlot(TopicID topicID);
+
+    /**
+     * Returns the slot for the given topic, or nullptr if it has none.
+     */
+    const Slot* FindSlot(TopicID topicID) const;
+};
+
+}  // namespace frc3512
+
+#include "Blackboard.inc"
@@ -0,0 +1,80 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <thread>
+#include <vector>
+
+#include <wpi/condition_variable.h>
+#include <wpi/mutex.h>
+
+#include "communications/Strand.hpp"
+
+namespace frc3512 {
+
+/**
+ * Notifies Strands when deadlines they've registered pass.
+ *
+ * PublishNode uses this to time out requests. A strand's HasWork() should
+ * return true once its deadline has passed, so the notification gets it
+ * scheduled.
+ */
+class DeadlineTimer {
+public:
+    ~DeadlineTimer();
+
+    DeadlineTimer(const DeadlineTimer&) = delete;
+    DeadlineTimer& operator=(const DeadlineTimer&) = delete;
+
+    static DeadlineTimer& GetInstance();
+
+    /**
+     * Notifies the given strand once the given time has passed.
+     *
+     * @param deadline The time in nanoseconds on the clock of
+     *                 NodeStats::Now().
+     * @param strand   The strand to notify.
+     */
+    void Add(int64_t deadline, Strand& strand);
+
+    /**
+     * Removes every deadline of the given strand.
+     *
+     * Once this returns, the strand won't be notified again, so it may be
+     * destroyed.
+     *
+     * @param strand The strand.
+     */
+    void Cancel(Strand& strand);
+
+private:
+    struct Entry {
+        int64_t deadline;
+        Strand* strand;
+
+        // Orders the heap so the earliest deadline is at the front
+        bool operator>(const Entry& rhs) const {
+            return deadline > rhs.deadline;
+        }
+    };
+
+    wpi::mutex m_mutex;
+    wpi::condition_variable m_ready;
+
+    // Kept as a min-heap on deadline
+    std::vector<Entry> m_entries;
+
+    bool m_isRunning = true;
+    std::thread m_thread;
+
+    DeadlineTimer();
+
+    /**
+     * Sleeps until the earliest deadline, then notifies its strand.
+     */
+    void Run();
+};
+
+}  // namespace frc3512
@@ -0,0 +1,133 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stddef.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <wpi/condition_variable.h>
+#include <wpi/mutex.h>
+
+#include "communications/LockFreeQueue.hpp"
+#include "communications/Strand.hpp"
+
+namespace frc3512 {
+
+/**
+ * A small pool of worker threads which runs Strands.
+ *
+ * Each worker has its own run queue. A strand scheduled from a worker goes on
+ * that worker's queue, and a worker whose queue is empty steals from the
+ * others before going to sleep. This lets a handful of threads serve every
+ * PublishNode instead of each node sleeping in a thread of its own.
+ */
+class Executor {
+public:
+    /**
+     * Worker count of the default executor. The roboRIO has two cores.
+     */
+    static constexpr int kDefaultNumWorkers = 2;
+
+    /**
+     * Priority of the default executor's workers. Zero leaves them at normal
+     * priority, below the real-time notifier threads.
+     */
+    static constexpr int kDefaultPriority = 0;
+
+    /**
+     * Maximum number of strands per executor. Constructing more aborts the
+     * program, since Schedule() would have nowhere to queue them.
+     */
+    static constexpr int kMaxStrands = 64;
+
+    /**
+     * Constructs an Executor.
+     *
+     * @param numWorkers Number of worker threads.
+     * @param priority   Real-time priority of the workers from 1 to 99, or 0
+     *                   for normal priority.
+     */
+    Executor(int numWorkers, int priority);
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    /**
+     * Returns the executor PublishNodes run on unless given another one.
+     */
+    static Executor& GetDefault();
+
+    /**
+     * Queues a strand to be run by a worker.
+     *
+     * Strands call this themselves from Strand::Notify().
+     *
+     * @param strand The strand to run.
+     */
+    void Schedule(Strand& strand);
+
+    /**
+     * Returns the number of worker threads.
+     */
+    int NumWorkers() const;
+
+private:
+    friend class Strand;
+
+    struct Worker {
+        // Each strand is queued at most once, so this can't overflow
+        LockFreeQueue<Strand*> queue{kMaxStrands};
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<bool> m_isRunning{true};
+
+    // Spreads strands scheduled from outside the executor across workers
+    std::atomic<size_t> m_nextWorker{0};
+
+    std::atomic<int> m_numStrands{0};
+
+    // Only used to put idle workers to sleep. Schedule() touches it only if
+    // m_numSleeping is nonzero.
+    wpi::mutex m_mutex;
+    wpi::condition_variable m_ready;
+    std::atomic<int> m_numSleeping{0};
+
+    /**
+     * Counts a strand constructed on the executor, aborting if there are more
+     * than kMaxStrands.
+     */
+    void AddStrand();
+
+    /**
+     * Counts a strand destroyed.
+     */
+    void RemoveStrand();
+
+    /**
+     * Pops a strand from the given worker's queue, or steals one from another
+     * worker's.
+     *
+     * @return The strand, or nullptr if every queue was empty.
+     */
+    Strand* FindWork(size_t index);
+
+    /**
+     * Returns true if any worker's queue holds a strand.
+     */
+    bool HasWork() const;
+
+    /**
+     * Runs strands until the executor deconstructs, sleeping while there are
+     * none.
+     */
+    void RunWorker(size_t index, int priority);
+};
+
+}  // namespace frc3512
@@ -0,0 +1,134 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stddef.h>
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace frc3512 {
+
+/**
+ * A bounded, lock-free queue which any number of threads may push into.
+ *
+ * This is Dmitry Vyukov's bounded MPMC queue. Each slot carries a sequence
+ * number which tells producers and consumers whether it's free or holds a
+ * value, so a push or pop only contends on a single compare-and-swap of the
+ * enqueue or dequeue position. Values are constructed in place in their slot,
+ * so a push never allocates.
+ *
+ * @tparam T Element type.
+ */
+template <class T>
+class LockFreeQueue {
+public:
+    /**
+     * Constructs a LockFreeQueue.
+     *
+     * @param capacity Maximum number of elements. Rounded up to the next power
+     *                 of two.
+     */
+    explicit LockFreeQueue(size_t capacity);
+    ~LockFreeQueue();
+
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+    /**
+     * Constructs an element in place at the back of the queue.
+     *
+     * @param args Arguments forwarded to T's constructor.
+     * @return False if the queue was full.
+     */
+    template <class... Args>
+    bool Emplace(Args&&... args);
+
+    /**
+     * Invokes the given function on the element at the front of the queue,
+     * then removes it.
+     *
+     * The element isn't copied out of its slot. The slot stays claimed until
+     * the function returns, so the function should be short.
+     *
+     * @param func Function taking a T&.
+     * @return False if the queue was empty.
+     */
+    template <class F>
+    bool Consume(F&& func);
+
+    /**
+     * Moves the element at the front of the queue into the given object.
+     *
+     * @param value Destination of the popped element.
+     * @return False if the queue was empty.
+     */
+    bool Pop(T& value);
+
+    /**
+     * Moves up to maxCount elements from the front of the queue into the given
+     * output iterator.
+     *
+     * All of the elements are claimed with one compare-and-swap of the dequeue
+     * position rather than one per element, so a consumer draining a backlog
+     * contends with producers once per batch.
+     *
+     * @param out      Destination of the popped elements.
+     * @param maxCount Maximum number of elements to pop.
+     * @return The number of elements popped.
+     */
+    template <class OutputIt>
+    size_t PopBatch(OutputIt out, size_t maxCount);
+
+    /**
+     * Returns true if the queue contained no elements at the time of the call.
+     */
+    bool Empty() const;
+
+    /**
+     * Returns the number of elements in the queue at about the time of the
+     * call.
+     *
+     * Elements being pushed or popped concurrently may or may not be counted.
+     */
+    size_t Size() const;
+
+    /**
+     * Returns the maximum number of elements the queue can hold.
+     */
+    size_t Capacity() const;
+
+private:
+    // Keeps the enqueue and dequeue positions on separate cache lines so
+    // producers and the consumer don't false share
+    static constexpr size_t kCacheLineSize = 64;
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+
+        T* Get() { return std::launder(reinterpret_cast<T*>(&storage)); }
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_mask;
+
+    alignas(kCacheLineSize) std::atomic<size_t> m_enqueuePos{0};
+    alignas(kCacheLineSize) std::atomic<size_t> m_dequeuePos{0};
+
+    /**
+     * Claims the slot at the front of the queue.
+     *
+     * @return The claimed slot and its position, or nullptr if empty.
+     */
+    Slot* ClaimFront(size_t& pos);
+
+    static size_t RoundUpToPowerOfTwo(size_t value);
+};
+
+}  // namespace frc3512
+
+#include "LockFreeQueue.inc"
@@ -0,0 +1,17 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stdint.h>
+
+namespace frc3512 {
+
+/**
+ * Which of a PublishNode's queues a message waits in.
+ *
+ * A node always processes queued kHigh messages before kNormal ones, so a
+ * command doesn't wait behind a backlog of telemetry.
+ */
+enum class MessagePriority : uint8_t { kHigh, kNormal };
+
+}  // namespace frc3512
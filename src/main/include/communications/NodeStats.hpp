@@ -0,0 +1,246 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "communications/Message.hpp"
+#include "communications/PacketType.hpp"
+
+namespace frc3512 {
+
+/**
+ * Counts of durations in power-of-two buckets.
+ *
+ * Bucket 0 counts zero durations and bucket i counts durations in
+ * [2^(i - 1), 2^i) nanoseconds. The last bucket also counts everything longer.
+ */
+struct Histogram {
+    static constexpr size_t kNumBuckets = 28;
+
+    std::array<uint64_t, kNumBuckets> buckets{};
+
+    /**
+     * Returns the bucket a duration falls in.
+     *
+     * @param ns Duration in nanoseconds.
+     */
+    static size_t BucketOf(int64_t ns);
+
+    /**
+     * Returns the number of durations counted.
+     */
+    uint64_t Count() const;
+
+    /**
+     * Returns an upper bound on the given percentile in nanoseconds.
+     *
+     * @param percentile Percentile from 0 to 100.
+     */
+    int64_t Percentile(double percentile) const;
+};
+
+/**
+ * A snapshot of one PublishNode's statistics. See PublishNode::GetStats().
+ */
+struct NodeStatsSnapshot {
+    struct TypeStats {
+        // Messages of this type the node published
+        uint64_t published = 0;
+
+        // Messages of this type the node processed
+        uint64_t received = 0;
+
+        // Messages of this type the node discarded without processing
+        uint64_t dropped = 0;
+
+        // Packet bytes copied into the node's queues and mailboxes
+        uint64_t bytesEnqueued = 0;
+
+        // Total time spent in ProcessMessage()
+        uint64_t processingNs = 0;
+
+        // Time from being queued to ProcessMessage() being called
+        Histogram queueLatency;
+
+        // Time spent in each ProcessMessage() call
+        Histogram processingTime;
+    };
+
+    // Delivery latency of messages from one publisher
+    struct EdgeStats {
+        std::string publisher;
+
+        // Time from being published to ProcessMessage() being called
+        Histogram deliveryLatency;
+    };
+
+    std::string nodeName;
+
+    // Indexed by PacketType
+    std::array<TypeStats, std::variant_size_v<Message>> types;
+
+    // Indexed by MessagePriority
+    std::array<size_t, 2> queueDepth{};
+    std::array<size_t, 2> maxQueueDepth{};
+
+    // One per publisher the node subscribed to
+    std::vector<EdgeStats> edges;
+
+    /**
+     * Returns a human-readable summary with one line per packet type the node
+     * published or received.
+     */
+    std::string ToString() const;
+
+    /**
+     * Writes the header row for WriteCsv().
+     *
+     * @param os The stream to write to.
+     */
+    static void WriteCsvHeader(std::ostream& os);
+
+    /**
+     * Writes one CSV row per packet type.
+     *
+     * @param os The stream to write to.
+     */
+    void WriteCsv(std::ostream& os) const;
+
+    /**
+     * Writes the header row for WriteEdgeCsv().
+     *
+     * @param os The stream to write to.
+     */
+    static void WriteEdgeCsvHeader(std::ostream& os);
+
+    /**
+     * Writes one CSV row per publisher the node subscribed to.
+     *
+     * @param os The stream to write to.
+     */
+    void WriteEdgeCsv(std::ostream& os) const;
+};
+
+/**
+ * The counters behind a PublishNode's statistics.
+ *
+ * Any thread may record into them. Each thread is assigned one of several
+ * shards, so threads rarely write the same cache line and each update is a
+ * single relaxed atomic add. Snapshot() sums the shards.
+ */
+class NodeStats {
+public:
+    /**
+     * Maximum number of publishers a node tracks delivery latency from.
+     */
+    static constexpr size_t kMaxEdges = 16;
+
+    /**
+     * Edge index of messages that weren't published to the node by another
+     * node, or whose publisher didn't fit in kMaxEdges.
+     */
+    static constexpr size_t kNoEdge = kMaxEdges;
+
+    /**
+     * Returns the current time in nanoseconds for timing messages.
+     */
+    static int64_t Now();
+
+    /**
+     * Counts a message the node published.
+     *
+     * @param type The message's packet type.
+     */
+    void RecordPublished(PacketType type);
+
+    /**
+     * Counts a message copied into the node's queues.
+     *
+     * @param type  The message's packet type.
+     * @param bytes Size of the packet.
+     */
+    void RecordEnqueued(PacketType type, size_t bytes);
+
+    /**
+     * Counts a message the node processed.
+     *
+     * @param type         The message's packet type.
+     * @param queuedNs     Time from being queued until processing started.
+     * @param processingNs Time spent in ProcessMessage().
+     */
+    void RecordProcessed(PacketType type, int64_t queuedNs,
+                         int64_t processingNs);
+
+    /**
+     * Returns the edge index for messages from the given publisher, adding
+     * one if it doesn't have one yet.
+     *
+     * Like PublishNode::Subscribe(), which calls this, it must not be called
+     * from several threads at once.
+     *
+     * @param publisherName The publisher's node name.
+     * @return The edge index, or kNoEdge if there are already kMaxEdges.
+     */
+    size_t AddEdge(std::string_view publisherName);
+
+    /**
+     * Counts a message delivered over an edge.
+     *
+     * @param edge      The edge index from AddEdge().
+     * @param latencyNs Time from being published until processing started.
+     */
+    void RecordDelivered(size_t edge, int64_t latencyNs);
+
+    /**
+     * Adds the counters to the given snapshot's.
+     *
+     * @param snapshot The snapshot to fill in.
+     */
+    void Snapshot(NodeStatsSnapshot& snapshot) const;
+
+private:
+    static constexpr size_t kNumShards = 4;
+    static constexpr size_t kCacheLineSize = 64;
+
+    struct TypeCounters {
+        std::atomic<uint64_t> published{0};
+        std::atomic<uint64_t> received{0};
+        std::atomic<uint64_t> bytesEnqueued{0};
+        std::atomic<uint64_t> processingNs{0};
+        std::array<std::atomic<uint64_t>, Histogram::kNumBuckets>
+            queueLatency{};
+        std::array<std::atomic<uint64_t>, Histogram::kNumBuckets>
+            processingTime{};
+    };
+
+    struct alignas(kCacheLineSize) Shard {
+        std::array<TypeCounters, std::variant_size_v<Message>> types;
+    };
+
+    std::array<Shard, kNumShards> m_shards;
+
+    // Edges are only recorded by the node's own thread, so they aren't
+    // sharded
+    std::array<std::string, kMaxEdges> m_edgeNames;
+    std::array<std::array<std::atomic<uint64_t>, Histogram::kNumBuckets>,
+               kMaxEdges>
+        m_edgeLatencies{};
+    std::atomic<size_t> m_numEdges{0};
+
+    /**
+     * Returns the current thread's shard.
+     */
+    Shard& GetShard();
+};
+
+}  // namespace frc3512
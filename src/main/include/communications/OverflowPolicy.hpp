@@ -0,0 +1,36 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stdint.h>
+
+namespace frc3512 {
+
+/**
+ * What a PublishNode does with a message of a given type when it can't keep
+ * up with its publishers.
+ */
+enum class OverflowPolicy : uint8_t {
+    /**
+     * Queue messages in FIFO order. If the queue is full, the oldest queued
+     * message is discarded to make room.
+     */
+    kDropOldest,
+
+    /**
+     * Queue messages in FIFO order. If the queue is full, the incoming message
+     * is discarded.
+     */
+    kDropNewest,
+
+    /**
+     * Keep only the most recent message per topic. A message that arrives
+     * before the previous one on its topic was processed replaces it, so a
+     * backed-up node only ever processes the freshest state.
+     *
+     * Meant for periodic state like HIDPacket and ElevatorStatusPacket.
+     */
+    kLatest
+};
+
+}  // namespace frc3512
@@ -2,40 +2,80 @@
 
 #pragma once
 
+#include <stdint.h>
+
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <limits>
 #include <string>
 #include <string_view>
-#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
 #include <vector>
 
-#include <wpi/circular_buffer.h>
-#include <wpi/condition_variable.h>
+#include <wpi/mutex.h>
 
+#include "communications/Blackboard.hpp"
+#include "communications/DeadlineTimer.hpp"
+#include "communications/Executor.hpp"
+#include "communications/LockFreeQueue.hpp"
+#include "communications/MessagePriority.hpp"
+#include "communications/NodeStats.hpp"
+#include "communications/OverflowPolicy.hpp"
 #include "communications/PublishNodeBase.hpp"
+#include "communications/Recorder.hpp"
+#include "communications/ShmTransport.hpp"
+#include "communications/Strand.hpp"
+#include "communications/SubscriptionFilter.hpp"
+#include "communications/Topic.hpp"
 
 namespace frc3512 {
 
 /**
  * A communication layer that can pass messages between others who have
  * inherited it through a publish-subscribe architecture
+ *
+ * Messages are processed on a shared Executor rather than a thread per node.
+ * Each node is a Strand on it, so a node processes its messages one at a time
+ * and in order.
  */
-class PublishNode : public PublishNodeBase {
+class PublishNode : public PublishNodeBase, private Strand {
 public:
     /**
      * Construct a PublishNode.
      *
      * @param nodeName Name of node.
+     * @param executor Executor to process messages on.
      */
-    explicit PublishNode(std::string_view nodeName = "Misc");
+    explicit PublishNode(std::string_view nodeName = "Misc",
+                         Executor& executor = Executor::GetDefault());
     virtual ~PublishNode();
 
+    /**
+     * Stops processing messages and waits for a running ProcessMessage() call
+     * to return.
+     *
+     * The destructor calls this, but by then a derived class's members have
+     * already been destroyed. Derived classes whose ProcessMessage() overrides
+     * use their own members should call this first in their destructor.
+     */
+    void Stop();
+
     /**
      * Adds this object to the specified PublishNode's subscriber list.
      *
+     * If this object is already subscribed, its filter is replaced.
+     *
      * @param publisher The PublishNode that this instance wants to recieve
      *                  event from.
+     * @param filter    Selects which of the publisher's messages to receive.
+     *                  By default, all of them are received.
      */
-    void Subscribe(PublishNode& publisher);
+    void Subscribe(PublishNode& publisher, SubscriptionFilter filter = {});
 
     /**
      * Removes this object from the specified PublishNode's subscriber list.
@@ -45,6 +85,108 @@ public:
      */
     void Unsubscribe(PublishNode& publisher);
 
+    /**
+     * Copies every message this node publishes that passes the filter into
+     * the given shared-memory ring, where other processes can read it.
+     *
+     * Like Subscribe(), this should be called before messages are published.
+     *
+     * @param writer The ring to publish into. Must outlive this node.
+     * @param filter The messages to copy. By default, all of them are.
+     */
+    void PublishTo(ShmWriter& writer, SubscriptionFilter filter = {});
+
+    /**
+     * Sets how this node handles messages of the given type when it falls
+     * behind. The default is OverflowPolicy::kDropOldest.
+     *
+     * Like Subscribe(), this should be called before messages are published to
+     * the node.
+     *
+     * @param type   The packet type.
+     * @param policy The policy to apply to messages of that type.
+     */
+    void SetOverflowPolicy(PacketType type, OverflowPolicy policy);
+
+    /**
+     * Sets how old a message of the given type may be when this node gets to
+     * it. Older messages are dropped instead of processed. By default,
+     * messages never go stale.
+     *
+     * A message's age is measured from when it was published. For example,
+     * a drivetrain can drop joystick input that sat in its queue long enough
+     * to no longer reflect what the driver is doing.
+     *
+     * Like Subscribe(), this should be called before messages are published to
+     * the node.
+     *
+     * @param type   The packet type.
+     * @param maxAge The maximum age, or zero for no limit.
+     */
+    void SetMaxAge(PacketType type, std::chrono::nanoseconds maxAge);
+
+    /**
+     * Returns the number of messages of the given type this node discarded
+     * without processing.
+     *
+     * This includes messages evicted from or rejected by a full queue,
+     * messages replaced in a kLatest mailbox by a newer one and messages older
+     * than the type's maximum age.
+     *
+     * @param type The packet type.
+     */
+    uint64_t GetDropCount(PacketType type) const;
+
+    /**
+     * Sets which queue this node puts messages of the given type in. By
+     * default, CommandPackets are MessagePriority::kHigh and everything else
+     * is kNormal. Mailboxes for kLatest messages are processed alongside
+     * kNormal messages regardless.
+     *
+     * Like Subscribe(), this should be called before messages are published to
+     * the node.
+     *
+     * @param type     The packet type.
+     * @param priority The queue's priority.
+     */
+    void SetPriority(PacketType type, MessagePriority priority);
+
+    /**
+     * Returns the number of messages waiting in the queue of the given
+     * priority.
+     *
+     * Messages waiting in kLatest mailboxes aren't counted.
+     *
+     * @param priority The queue's priority.
+     */
+    size_t GetQueueDepth(MessagePriority priority) const;
+
+    /**
+     * Returns the most messages that have waited in the queue of the given
+     * priority at once.
+     *
+     * A message waits behind at most this many others of its priority, plus
+     * any of higher priority.
+     *
+     * @param priority The queue's priority.
+     */
+    size_t GetMaxQueueDepth(MessagePriority priority) const;
+
+    /**
+     * Returns a snapshot of this node's message counts, queue depths, and
+     * timings since it was constructed.
+     *
+     * This is safe to call from any thread while messages are flowing. The
+     * counters aren't read atomically as a group, so they may be off by the
+     * few messages in flight.
+     */
+    NodeStatsSnapshot GetStats() const;
+
+    /**
+     * Returns the name this node was constructed with.
+     */
+    std::string_view GetNodeName() const;
+
     /**
      * Get the button value (starting at button 1).
      *
@@ -61,9 +203,20 @@ public:
     static bool GetRawButton(const HIDPacket& msg, int joystick, int button);
 
     /**
-     * Sends a packet to every subscriber.
+     * Sends a packet to every subscriber and records it in the Blackboard as
+     * the latest packet on its topic.
+     *
+     * Subscribers live in the same process, so they receive the packet itself
+     * rather than a serialized copy.
      *
-     * @param p Any packet with a Serialize() method.
+     * The packet's topic is qualified with this node's name, so a topic of
+     * "Status" published by "Elevator" arrives as "Elevator/Status" with a
+     * topicID of "Elevator/Status"_topic.
+     *
+     * While the Recorder is recording, the publication and each delivery to a
+     * subscriber are recorded.
+     *
+     * @param p Any packet type held by Message.
      */
     template <class P>
     void Publish(P p);
@@ -71,27 +224,274 @@ public:
     /**
      * Sends a packet to the object it's called on.
      *
-     * @param p Any packet with a Serialize() method.
+     * Unlike Publish(), the topic isn't qualified with a node name. If the
+     * packet has no topicID, it's set from the topic as given. Like
+     * Publish(), the topic is pointed at the name interned in TopicRegistry,
+     * so the caller's string needn't outlive the call.
+     *
+     * If the node has fallen behind, the packet's OverflowPolicy applies.
+     *
+     * @param p Any packet type held by Message.
      */
     template <class P>
     void PushMessage(P p);
 
+    /**
+     * Called with the reply to a request, or with nullptr if the request
+     * timed out.
+     */
+    using ReplyCallback = std::function<void(const CommandPacket* reply)>;
+
+    /**
+     * Publishes a command which expects a reply.
+     *
+     * The command is published like Publish() with a new requestID. The node
+     * which handles it should pass that requestID to Reply(). Replies arrive
+     * as CommandPackets, so this node must subscribe to that node's commands.
+     *
+     * The callback is called once on this node's thread, like
+     * ProcessMessage(): with the reply, or with nullptr if no reply arrived
+     * before the timeout. The reply isn't passed to ProcessMessage().
+     *
+     * @param request  The command. Its reply flag and requestID are
+     *                 overwritten.
+     * @param timeout  How long to wait for the reply.
+     * @param callback Called with the reply or nullptr.
+     * @return The requestID the command was published with.
+     */
+    uint32_t Request(CommandPacket request, std::chrono::nanoseconds timeout,
+                     ReplyCallback callback);
+
+    /**
+     * Publishes a command which expects a reply.
+     *
+     * Like the callback overload, but the returned future is set to true when
+     * the reply arrives or false when the request times out. Don't wait on it
+     * from this node's ProcessMessage(), since the future is set from the
+     * same thread.
+     *
+     * @param request The command. Its reply flag and requestID are
+     *                overwritten.
+     * @param timeout How long to wait for the reply.
+     */
+    std::future<bool> Request(CommandPacket request,
+                              std::chrono::nanoseconds timeout);
+
+    /**
+     * Publishes the reply to a request.
+     *
+     * @param requestID The requestID of the CommandPacket being answered.
+     *                  Nothing is published if it's zero, so it's safe to
+     *                  pass the requestID of any command.
+     */
+    void Reply(uint32_t requestID);
+
+    /**
+     * Maximum number of messages a node can have queued per priority.
+     */
+    static constexpr int kNodeQueueSize = 64;
+
+    /**
+     * Maximum number of topics a node can hold kLatest mailboxes for. Messages
+     * on further topics are queued as if their policy were kDropOldest.
+     */
+    static constexpr int kMaxMailboxes = 16;
+
+    /**
+     * Maximum number of messages a node takes from each of its queues before
+     * giving its worker to the next node.
+     */
+    static constexpr int kMaxBatchSize = 16;
+
 private:
-    static constexpr int kNodeQueueSize = 1024;
+    friend class Replayer;
 
     std::string m_nodeName;
-    std::vector<PublishNode*> m_subList;
-    wpi::circular_buffer<char> m_queue{kNodeQueueSize};
 
-    std::thread m_thread;
+    // Identifies the node in recordings
+    NodeID m_nodeID;
+
+    // FNV-1a hash state of "m_nodeName/", which Publish() continues over the
+    // packet's topic
+    uint32_t m_topicPrefixHash;
+
+    struct Subscription {
+        PublishNode* node;
+        SubscriptionFilter filter;
+
+        // Index of this publisher in the subscriber's NodeStats edges
+        size_t edge;
+    };
+
+    // A queued message, when it was queued and which edge it arrived on
+    struct Envelope {
+        int64_t enqueueTime = 0;
+        size_t edge = NodeStats::kNoEdge;
+        Message message;
+
+        Envelope() = default;
+
+        template <class P>
+        Envelope(int64_t enqueueTime, size_t edge, P&& p)
+            : enqueueTime{enqueueTime},
+              edge{edge},
+              message{std::in_place_type<std::decay_t<P>>, std::forward<P>(p)} {
+        }
+    };
+
+    // Holds the newest message on a kLatest topic until the node's thread
+    // processes it
+    struct Mailbox {
+        std::atomic<TopicID> topicID{0};
+        wpi::mutex mutex;
+        Envelope envelope;
+        bool pending = false;
+    };
+
+    struct Lane {
+        LockFreeQueue<Envelope> queue{kNodeQueueSize};
+        std::atomic<size_t> maxDepth{0};
+    };
+
+    static constexpr size_t kNumPacketTypes = std::variant_size_v<Message>;
+    static constexpr size_t kNumPriorities = 2;
+
+    struct Transport {
+        ShmWriter* writer;
+        SubscriptionFilter filter;
+    };
+
+    std::vector<Subscription> m_subList;
+    std::vector<Transport> m_transports;
+
+    // Indexed by MessagePriority
+    std::array<Lane, kNumPriorities> m_lanes;
+    std::array<MessagePriority, kNumPacketTypes> m_priorities;
+
+    std::array<OverflowPolicy, kNumPacketTypes> m_overflowPolicies{};
+
+    // In nanoseconds. Zero means messages of that type never go stale.
+    std::array<int64_t, kNumPacketTypes> m_maxAges{};
+    std::array<std::atomic<uint64_t>, kNumPacketTypes> m_dropCounts{};
+
+    // A mailbox is queued here when it goes from empty to pending, so each
+    // one appears at most once and the queue can't overflow
+    std::array<Mailbox, kMaxMailboxes> m_mailboxes;
+    LockFreeQueue<Mailbox*> m_pendingMailboxes{kMaxMailboxes};
+
     std::atomic<bool> m_isRunning{true};
-    wpi::condition_variable m_ready;
+
+    NodeStats m_stats;
+
+    struct PendingRequest {
+        uint32_t id;
+        int64_t deadline;
+        ReplyCallback callback;
+    };
+
+    wpi::mutex m_requestMutex;
+    std::vector<PendingRequest> m_requests;
+
+    // Earliest deadline in m_requests, or the maximum int64_t if there are
+    // none. Read without the lock so HasWork() stays cheap.
+    std::atomic<int64_t> m_nextDeadline{std::numeric_limits<int64_t>::max()};
+
+    // Set once this node has registered a deadline with the DeadlineTimer
+    std::atomic<bool> m_usesTimer{false};
+
+    /**
+     * Hands the given packet to this node's thread according to the packet
+     * type's OverflowPolicy.
+     *
+     * @param p   Any packet type held by Message.
+     * @param now  The time from NodeStats::Now(). Publish() reads the clock
+     *             once for every subscriber.
+     * @param edge The publisher's edge index in this node's NodeStats, or
+     *             NodeStats::kNoEdge.
+     */
+    template <class P>
+    void Enqueue(P&& p, int64_t now, size_t edge);
+
+    /**
+     * Returns the kLatest mailbox for the given topic, claiming a free one if
+     * the topic doesn't have one yet.
+     *
+     * @return The mailbox, or nullptr if every mailbox belongs to another
+     *         topic.
+     */
+    Mailbox* GetMailbox(TopicID topicID);
+
+    /**
+     * Passes a dequeued message to ProcessMessage() and records how long it
+     * waited and how long it took.
+     *
+     * @param envelope The message.
+     * @param time     The time processing started. Updated to the time it
+     *                 ended, which is when the next message's processing
+     *                 starts, so each message costs one clock read.
+     */
+    void Process(const Envelope& envelope, int64_t& time);
+
+    /**
+     * Passes the given reply to the callback of the request it answers.
+     *
+     * @return False if the packet isn't a reply to one of this node's
+     *         pending requests.
+     */
+    bool CompleteRequest(const CommandPacket& reply);
+
+    /**
+     * Passes a message to the callback of the request it answers, or to
+     * ProcessMessage() if it isn't a reply to a pending request.
+     *
+     * Process() and Replayer both deliver messages through this.
+     */
+    void CompleteOrDispatch(const Message& message);
+
+    /**
+     * Returns the IDs of the requests awaiting a reply.
+     *
+     * Replayer uses this to match requests made during replay with the ones
+     * in the recording.
+     */
+    std::vector<uint32_t> GetPendingRequestIDs();
+
+    /**
+     * Calls the callbacks of requests whose deadline has passed with nullptr.
+     *
+     * @param now The time from NodeStats::Now().
+     */
+    void ExpireRequests(int64_t now);
+
+    /**
+     * Sets m_nextDeadline from m_requests. m_requestMutex must be held.
+     */
+    void UpdateNextDeadline();
+
+    /**
+     * Processes the message in one pending mailbox.
+     *
+     * @param time See Process().
+     * @return False if no mailbox was pending.
+     */
+    bool ProcessMailbox(int64_t& time);
+
+    /**
+     * Processes up to kMaxBatchSize messages from each queue and the
+     * mailboxes.
+     *
+     * kHigh messages are processed first. kNormal messages and mailboxes take
+     * turns after that. Each queue's messages are drained with one
+     * LockFreeQueue::PopBatch() call, so the node contends with publishers
+     * once per batch rather than once per message.
+     */
+    void RunBatch() override;
 
     /**
-     * Blocks the thread until the queue receives at least one set of characters
-     * of a message or until the node deconstructs, then processes each message.
+     * Returns true if a queue or a mailbox holds a message or a request's
+     * deadline has passed.
      */
-    void RunFramework();
+    bool HasWork() const override;
 };
 
 }  // namespace frc3512
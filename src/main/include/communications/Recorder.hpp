@@ -0,0 +1,186 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <wpi/mutex.h>
+
+#include "communications/LockFreeQueue.hpp"
+#include "communications/Message.hpp"
+#include "communications/Topic.hpp"
+
+namespace frc3512 {
+
+/**
+ * Identifies a PublishNode in a recording. It's the FNV-1a hash of the node's
+ * name, like a TopicID.
+ */
+using NodeID = uint32_t;
+
+/**
+ * Records every message that crosses a PublishNode to a binary log, which
+ * Replayer can feed back into freshly constructed nodes.
+ *
+ * PublishNode calls Record() for each message it publishes and for each
+ * subscriber it delivers the message to. Record() only copies the message
+ * into a lock-free queue. A background thread serializes the queued messages
+ * and writes them to the file, so the publisher never waits on the disk. If
+ * the queue fills, messages are dropped and counted rather than blocking.
+ *
+ * The log is a header followed by records in host byte order:
+ *
+ *   Header:  char magic[8] = "3512REC", uint32 version, uint32 schemaHash
+ *   Node:    uint8 kind = 0, uint32 NodeID, uint8 length, char name[length]
+ *   Topic:   uint8 kind = 1, uint32 TopicID, uint8 length, char name[length]
+ *   Message: uint8 kind = 2, int64 time, uint32 source, uint32 destination,
+ *            uint16 length, char packet[length]
+ *
+ * A node or topic record precedes the first message that refers to it. A
+ * message's time is in nanoseconds since recording started and its packet is
+ * the output of the packet's Serialize(). schemaHash is kSchemaHash from
+ * PacketType.hpp.
+ */
+class Recorder {
+public:
+    static constexpr char kMagic[8] = "3512REC";
+    static constexpr uint32_t kVersion = 2;
+
+    /**
+     * The source of a message pushed from outside any node, or the
+     * destination of a message's publication record.
+     */
+    static constexpr NodeID kNoNode = 0;
+
+    static constexpr size_t kQueueSize = 4096;
+
+    static Recorder& GetInstance();
+
+    ~Recorder();
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    /**
+     * Starts recording to the given file, replacing its contents.
+     *
+     * Start() and Stop() should be called from one thread.
+     *
+     * @param filename The file to write.
+     * @return False if the file couldn't be opened or already recording.
+     */
+    bool Start(std::string_view filename);
+
+    /**
+     * Writes out the messages recorded so far and closes the file.
+     */
+    void Stop();
+
+    /**
+     * Returns true if messages are being recorded.
+     */
+    bool IsRecording() const {
+        return m_isRecording.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Records a node's name so recordings can refer to it by NodeID.
+     *
+     * @param id   The node's ID.
+     * @param name The node's name.
+     */
+    void RegisterNode(NodeID id, std::string_view name);
+
+    /**
+     * Queues a message to be written to the recording.
+     *
+     * @param time        The time from NodeStats::Now().
+     * @param source      The publishing node, or kNoNode.
+     * @param destination The receiving node, or kNoNode for the publication
+     *                    itself.
+     * @param p           Any packet type held by Message.
+     */
+    template <class P>
+    void Record(int64_t time, NodeID source, NodeID destination, const P& p);
+
+    /**
+     * Returns the number of messages dropped because the queue was full.
+     */
+    uint64_t GetDropCount() const;
+
+private:
+    struct Entry {
+        int64_t time = 0;
+        NodeID source = kNoNode;
+        NodeID destination = kNoNode;
+        Message message;
+
+        Entry() = default;
+
+        template <class P>
+        Entry(int64_t time, NodeID source, NodeID destination, const P& p)
+            : time{time},
+              source{source},
+              destination{destination},
+              message{std::in_place_type<P>, p} {}
+    };
+
+    LockFreeQueue<Entry> m_queue{kQueueSize};
+    std::atomic<bool> m_isRecording{false};
+    std::atomic<uint64_t> m_dropCount{0};
+
+    // Names of every node constructed so far
+    wpi::mutex m_nodeNameMutex;
+    std::unordered_map<NodeID, std::string> m_nodeNames;
+
+    // Only used by the writer thread while recording
+    std::array<Entry, 64> m_batch;
+    std::vector<char> m_serialized;
+    std::ofstream m_file;
+    int64_t m_startTime = 0;
+    std::unordered_set<NodeID> m_writtenNodes;
+    std::unordered_set<TopicID> m_writtenTopics;
+
+    std::atomic<bool> m_isWriterRunning{false};
+    std::thread m_writerThread;
+
+    Recorder() = default;
+
+    /**
+     * Writes queued messages to the file until recording stops.
+     */
+    void WriterMain();
+
+    /**
+     * Writes the queued messages to the file.
+     *
+     * @return The number of messages written.
+     */
+    size_t Drain();
+
+    void WriteEntry(const Entry& entry);
+    void WriteName(uint8_t kind, uint32_t id, std::string_view name);
+
+    template <class T>
+    void WriteValue(T value) {
+        m_file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+};
+
+}  // namespace frc3512
+
+#include "Recorder.inc"
@@ -0,0 +1,120 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+
+#include "communications/Message.hpp"
+#include "communications/PublishNode.hpp"
+#include "communications/Recorder.hpp"
+
+namespace frc3512 {
+
+/**
+ * How fast Replayer::Run() replays a recording.
+ */
+enum class ReplaySpeed {
+    // Waits between messages as long as they were apart when recorded
+    kRealTime,
+
+    // Replays every message immediately
+    kAsFastAsPossible
+};
+
+/**
+ * Feeds a recording made by Recorder back into freshly constructed nodes.
+ *
+ * Each message recorded for a node with the same name as an added node is
+ * passed to that node's ProcessMessage() on the thread calling Run(), in the
+ * order it was recorded. Replay doesn't depend on thread scheduling, so a
+ * recording always produces the same sequence of calls. Each recorded
+ * publication is also written to the Blackboard, so nodes which read other
+ * subsystems' status from there see it as it was.
+ *
+ * Replies are delivered like PublishNode delivers them: to the callback of
+ * the request they answer rather than to ProcessMessage(). Requests an added
+ * node makes before or during replay get new IDs, so each is matched, oldest
+ * first, with the next request the recording shows that node publishing, and
+ * replies to the recorded ID go to the new one.
+ *
+ * Usage:
+ * Elevator elevator;
+ * Replayer replayer{"Match.rec"};
+ * replayer.AddNode(elevator);
+ * replayer.Run(ReplaySpeed::kAsFastAsPossible);
+ */
+class Replayer {
+public:
+    /**
+     * Opens a recording.
+     *
+     * If the file can't be read or was recorded with a different message
+     * schema, an error is printed and Run() replays nothing.
+     *
+     * @param filename The recording to replay.
+     */
+    explicit Replayer(std::string_view filename);
+
+    Replayer(const Replayer&) = delete;
+    Replayer& operator=(const Replayer&) = delete;
+
+    /**
+     * Returns true if the recording was opened.
+     */
+    bool IsOpen() const;
+
+    /**
+     * Delivers messages recorded for the node with the given node's name to
+     * it.
+     *
+     * The node should not be subscribed to any other node, so it only
+     * receives the recorded messages.
+     *
+     * @param node The node. Must outlive Run().
+     */
+    void AddNode(PublishNode& node);
+
+    /**
+     * Replays the recording from the beginning.
+     *
+     * @param speed How fast to replay.
+     * @return The number of messages delivered to added nodes.
+     */
+    size_t Run(ReplaySpeed speed = ReplaySpeed::kAsFastAsPossible);
+
+private:
+    std::ifstream m_file;
+    std::streampos m_firstRecord;
+    std::unordered_map<NodeID, PublishNode*> m_nodes;
+
+    // Maps request IDs in the recording to the IDs of the matching requests
+    // made during replay
+    std::unordered_map<uint32_t, uint32_t> m_requestIDs;
+
+    /**
+     * Replaces the given message with the packet serialized in the buffer.
+     *
+     * @return False if the buffer doesn't hold a known packet type.
+     */
+    static bool Deserialize(const char* buf, size_t length, Message& message);
+
+    /**
+     * If the message is a request the given node published in the recording,
+     * matches it with the oldest unmatched request the node has made during
+     * replay.
+     */
+    void MatchRequest(PublishNode& node, const Message& message);
+
+    template <class T>
+    bool ReadValue(T& value) {
+        return static_cast<bool>(
+            m_file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+};
+
+}  // namespace frc3512
@@ -0,0 +1,244 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+
+#include "communications/Message.hpp"
+
+namespace frc3512 {
+
+/**
+ * The layout of a shared-memory ring, shared by ShmWriter and ShmReader.
+ *
+ * The ring is a header followed by a power-of-two number of slots. Each slot
+ * holds one packet in its serialized form and a sequence number which is odd
+ * while a writer is filling the slot. Writers never wait on readers: a reader
+ * that falls a lap behind finds its slots overwritten and skips ahead.
+ *
+ * Slots hold what the packet's Serialize() writes: its PacketType, header and
+ * packed big-endian fields. Unlike a Message, that layout doesn't depend on
+ * the compiler, and the header's schema hash tells readers when it changed.
+ */
+struct ShmRing {
+    static constexpr uint32_t kMagic = 0x33353132;  // "3512"
+    static constexpr uint32_t kVersion = 3;
+    static constexpr size_t kCacheLineSize = 64;
+    static constexpr size_t kSlotSize = 256;
+
+    /**
+     * Largest serialized packet a slot holds.
+     */
+    static constexpr size_t kMaxPacketSize =
+        kSlotSize - sizeof(uint64_t) - sizeof(uint32_t);
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                  "Atomics in shared memory must be lock-free");
+
+    struct alignas(kCacheLineSize) Header {
+        // Written before magic, which is written last
+        uint32_t version;
+        uint32_t numSlots;
+        uint32_t maxPacketSize;
+        uint32_t schemaHash;
+        std::atomic<uint32_t> magic;
+
+        // Number of messages writers have claimed slots for
+        alignas(kCacheLineSize) std::atomic<uint64_t> writeIndex;
+
+        // Incremented after every write. Readers sleep on it with a futex.
+        alignas(kCacheLineSize) std::atomic<uint32_t> futexWord;
+
+        // Set by a reader before it sleeps and cleared by the writer that
+        // wakes it, so only one write per sleep makes a system call
+        std::atomic<uint32_t> hasWaiters;
+    };
+
+    struct alignas(kCacheLineSize) Slot {
+        // 2 * index + 1 while message index is written, 2 * index + 2 after
+        std::atomic<uint64_t> sequence;
+
+        // Number of bytes of data in use
+        uint32_t size;
+
+        // The packet as written by its Serialize(). The first byte is its
+        // PacketType.
+        char data[kMaxPacketSize];
+    };
+    static_assert(sizeof(Slot) == kSlotSize);
+
+    /**
+     * Returns the size of a ring's mapping in bytes.
+     *
+     * @param numSlots Number of slots in the ring.
+     */
+    static size_t MappingSize(uint32_t numSlots) {
+        return sizeof(Header) + numSlots * sizeof(Slot);
+    }
+};
+
+/**
+ * Publishes messages into a named shared-memory ring, which processes outside
+ * the robot program can attach to with ShmReader.
+ *
+ * Writes are wait-free and never make a system call unless a reader is asleep
+ * waiting for a message, so slow or stalled readers can't slow the publisher.
+ * Any thread may write.
+ *
+ * Usage:
+ * ShmWriter writer{"/frc3512-telemetry"};
+ * m_elevator.PublishTo(writer);
+ */
+class ShmWriter {
+public:
+    static constexpr uint32_t kDefaultNumSlots = 1024;
+
+    /**
+     * Creates the ring, replacing any existing ring with the same name.
+     *
+     * If the ring can't be created, an error is printed and writes are
+     * discarded.
+     *
+     * @param name     Name of the shared memory object. Starts with a '/'.
+     * @param numSlots Number of messages the ring holds. Rounded up to the
+     *                 next power of two. Should be well above the number of
+     *                 threads that write at once.
+     */
+    explicit ShmWriter(std::string_view name,
+                       uint32_t numSlots = kDefaultNumSlots);
+    ~ShmWriter();
+
+    ShmWriter(const ShmWriter&) = delete;
+    ShmWriter& operator=(const ShmWriter&) = delete;
+
+    /**
+     * Returns true if the ring was created.
+     */
+    bool IsOpen() const;
+
+    /**
+     * Serializes a packet into the next slot of the ring.
+     *
+     * Only the topicID is serialized, not the topic name, so readers in
+     * another process identify the topic by its ID. Packets larger than
+     * ShmRing::kMaxPacketSize, which only strings can make, are skipped.
+     *
+     * @param p Any packet type held by Message.
+     */
+    template <class P>
+    void Write(const P& p);
+
+private:
+    std::string m_name;
+    void* m_mapping = nullptr;
+    size_t m_mappingSize = 0;
+    ShmRing::Header* m_header = nullptr;
+    ShmRing::Slot* m_slots = nullptr;
+    uint64_t m_mask = 0;
+
+    /**
+     * Wakes every reader waiting on the ring.
+     */
+    void WakeReaders();
+};
+
+/**
+ * Reads messages from a shared-memory ring created by ShmWriter in another
+ * process.
+ *
+ * Each message is copied out of the shared mapping and deserialized before
+ * it's visited, so a writer can't change it during the visit. A reader that
+ * falls more than a lap behind the writers skips the messages that were
+ * overwritten and counts them as lost.
+ *
+ * Usage:
+ * ShmReader reader{"/frc3512-telemetry"};
+ * while (reader.Wait(std::chrono::milliseconds(100))) {
+ *     while (reader.Read([](const Message& message) { ... })) {
+ *     }
+ * }
+ */
+class ShmReader {
+public:
+    /**
+     * Attaches to the ring with the given name.
+     *
+     * Only messages written after this call are read. If the ring doesn't
+     * exist or was built with a different message schema, an error is
+     * printed and reads return nothing.
+     *
+     * @param name Name the ShmWriter was created with.
+     */
+    explicit ShmReader(std::string_view name);
+    ~ShmReader();
+
+    ShmReader(const ShmReader&) = delete;
+    ShmReader& operator=(const ShmReader&) = delete;
+
+    /**
+     * Returns true if the reader attached to the ring.
+     */
+    bool IsOpen() const;
+
+    /**
+     * Invokes the given function on the next message in the ring.
+     *
+     * If the message was overwritten before it could be copied, or can't be
+     * deserialized, Read() skips it, counts it as lost and returns false.
+     * Its topic is looked up in this process's TopicRegistry, so it's empty
+     * unless this process interned the same name.
+     *
+     * @param func Function taking a const Message&.
+     * @return True if a message was visited.
+     */
+    template <class F>
+    bool Read(F&& func);
+
+    /**
+     * Blocks until a message is available to Read() or the timeout expires.
+     *
+     * @param timeout Maximum time to wait.
+     * @return True if a message is available.
+     */
+    bool Wait(std::chrono::nanoseconds timeout);
+
+    /**
+     * Returns the number of messages overwritten before they could be read.
+     */
+    uint64_t GetLostCount() const;
+
+private:
+    void* m_mapping = nullptr;
+    size_t m_mappingSize = 0;
+    ShmRing::Header* m_header = nullptr;
+    ShmRing::Slot* m_slots = nullptr;
+    uint64_t m_mask = 0;
+
+    uint64_t m_nextIndex = 0;
+    uint64_t m_lostCount = 0;
+
+    /**
+     * Returns true if the next message is complete or was overwritten.
+     */
+    bool HasMessage() const;
+
+    /**
+     * Deserializes a packet copied out of a slot.
+     *
+     * @param data    The packet.
+     * @param size    The packet's length.
+     * @param message Set to the packet.
+     * @return False if the packet type is unknown or the packet is cut off.
+     */
+    static bool Deserialize(const char* data, size_t size, Message& message);
+};
+
+}  // namespace frc3512
+
+#include "ShmTransport.inc"
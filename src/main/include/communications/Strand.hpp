@@ -0,0 +1,87 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+
+namespace frc3512 {
+
+class Executor;
+
+/**
+ * A serial stream of work run on an Executor.
+ *
+ * A strand is scheduled on the executor when it's notified of new work and
+ * runs on at most one worker at a time, so work within a strand keeps its
+ * order and never runs concurrently with itself.
+ */
+class Strand {
+public:
+    /**
+     * Constructs a Strand.
+     *
+     * @param executor The executor to run on.
+     */
+    explicit Strand(Executor& executor);
+
+    virtual ~Strand();
+
+    Strand(const Strand&) = delete;
+    Strand& operator=(const Strand&) = delete;
+
+    /**
+     * Schedules the strand on its executor unless it's already scheduled.
+     *
+     * Call this after making new work visible to HasWork().
+     */
+    void Notify();
+
+protected:
+    /**
+     * Performs a bounded amount of work.
+     *
+     * Strands share workers, so this should return after a batch of work
+     * rather than draining everything. The strand is rescheduled if HasWork()
+     * still returns true.
+     */
+    virtual void RunBatch() = 0;
+
+    /**
+     * Returns true if there's work waiting for RunBatch().
+     */
+    virtual bool HasWork() const = 0;
+
+    /**
+     * Stops the strand from being scheduled again and waits for a running
+     * batch to finish.
+     *
+     * Derived classes must call this in their destructor before destroying
+     * anything RunBatch() uses. Calls after the first do nothing.
+     */
+    void Close();
+
+private:
+    friend class Executor;
+
+    Executor& m_executor;
+
+    // Set while the strand is queued on or running in the executor
+    std::atomic<bool> m_isScheduled{false};
+
+    // Number of workers inside Run(). A worker that reschedules the strand
+    // can still be finishing Run() when another worker starts it, so this is
+    // a count rather than a flag. Close() waits for it to reach zero, since
+    // Run() uses the strand after clearing m_isScheduled.
+    std::atomic<int> m_numRunning{0};
+
+    // Set by Close(). Only the strand's owner reads it.
+    bool m_isClosed = false;
+
+    /**
+     * Runs one batch, then reschedules the strand if more work arrived.
+     * Called by the executor's workers.
+     */
+    void Run();
+};
+
+}  // namespace frc3512
@@ -0,0 +1,91 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <initializer_list>
+#include <variant>
+#include <vector>
+
+#include "communications/Message.hpp"
+#include "communications/PacketType.hpp"
+#include "communications/Topic.hpp"
+
+namespace frc3512 {
+
+/**
+ * Selects which of a publisher's messages a subscriber receives.
+ *
+ * The publisher checks the filter before queueing a message, so rejected
+ * messages cost the subscriber nothing.
+ *
+ * Usage:
+ * m_intake.Subscribe(robot, {{PacketType::kButton},
+ *                            {"Robot/AppendageStick2"_topic}});
+ */
+class SubscriptionFilter {
+public:
+    static_assert(std::variant_size_v<Message> <= 32,
+                  "PacketType no longer fits in the filter's type mask");
+
+    /**
+     * Constructs a filter which accepts every message.
+     */
+    SubscriptionFilter() = default;
+
+    /**
+     * Constructs a filter which accepts the given packet types on any topic.
+     *
+     * @param types Packet types to accept.
+     */
+    SubscriptionFilter(std::initializer_list<PacketType> types)
+        : m_typeMask{MakeTypeMask(types)} {}
+
+    /**
+     * Constructs a filter which accepts the given packet types on the given
+     * topics.
+     *
+     * @param types  Packet types to accept.
+     * @param topics Fully qualified topics to accept.
+     */
+    SubscriptionFilter(std::initializer_list<PacketType> types,
+                       std::initializer_list<TopicID> topics)
+        : m_typeMask{MakeTypeMask(types)}, m_topics{topics} {}
+
+    /**
+     * Returns true if a message of the given type and topic passes the filter.
+     *
+     * @param type  The message's packet type.
+     * @param topic The message's topic.
+     */
+    bool Accepts(PacketType type, TopicID topic) const {
+        if ((m_typeMask & TypeBit(type)) == 0) {
+            return false;
+        }
+        return m_topics.empty() ||
+               std::find(m_topics.begin(), m_topics.end(), topic) !=
+                   m_topics.end();
+    }
+
+private:
+    uint32_t m_typeMask = ~0u;
+
+    // An empty list accepts every topic
+    std::vector<TopicID> m_topics;
+
+    static constexpr uint32_t TypeBit(PacketType type) {
+        return 1u << static_cast<uint32_t>(type);
+    }
+
+    static uint32_t MakeTypeMask(std::initializer_list<PacketType> types) {
+        uint32_t mask = 0;
+        for (auto type : types) {
+            mask |= TypeBit(type);
+        }
+        return mask;
+    }
+};
+
+}  // namespace frc3512
@@ -0,0 +1,138 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <initializer_list>
+#include <string_view>
+
+namespace frc3512 {
+
+/**
+ * A compact identifier for a topic name such as "Robot/AppendageStick2".
+ *
+ * It's the 32-bit FNV-1a hash of the name, so literal topic names can be
+ * turned into IDs at compile time and used as case labels. Zero is reserved
+ * to mean "no topic".
+ */
+using TopicID = uint32_t;
+
+constexpr uint32_t kFnvOffsetBasis = 2166136261u;
+constexpr uint32_t kFnvPrime = 16777619u;
+
+/**
+ * Continues an FNV-1a hash over the given characters.
+ *
+ * Hashing "Robot/" then "AppendageStick2" gives the same state as hashing
+ * "Robot/AppendageStick2", so a node can hash its name prefix once.
+ *
+ * @param state Hash state from a previous call, or kFnvOffsetBasis.
+ * @param str   Characters to hash.
+ */
+constexpr uint32_t FnvAppend(uint32_t state, std::string_view str) {
+    for (size_t i = 0; i < str.size(); ++i) {
+        state ^= static_cast<uint8_t>(str[i]);
+        state *= kFnvPrime;
+    }
+    return state;
+}
+
+/**
+ * Turns a finished hash state into a TopicID.
+ */
+constexpr TopicID MakeTopicID(uint32_t state) { return state == 0 ? 1 : state; }
+
+/**
+ * Returns the TopicID of the given fully qualified topic name.
+ */
+constexpr TopicID HashTopic(std::string_view name) {
+    return MakeTopicID(FnvAppend(kFnvOffsetBasis, name));
+}
+
+/**
+ * Returns the TopicID of a topic name literal.
+ *
+ * Usage: case "Robot/AppendageStick2"_topic:
+ */
+constexpr TopicID operator""_topic(const char* str, size_t length) {
+    return HashTopic(std::string_view{str, length});
+}
+
+/**
+ * Maps TopicIDs back to topic names for logging.
+ *
+ * Names are interned into fixed storage which lives for the rest of the
+ * program, so the returned string_views never dangle. Lookups and repeated
+ * interning of a known topic are lock-free and don't allocate.
+ *
+ * Two names whose hashes collide share an ID. The first one interned is the
+ * name reported for it.
+ */
+class TopicRegistry {
+public:
+    /**
+     * Maximum number of distinct topics.
+     */
+    static constexpr size_t kMaxTopics = 256;
+
+    /**
+     * Names longer than this are truncated.
+     */
+    static constexpr size_t kMaxTopicLength = 63;
+
+    static TopicRegistry& GetInstance();
+
+    /**
+     * Records the name of a topic published by a node.
+     *
+     * @param id       The ID of the fully qualified topic name.
+     * @param nodeName Name of the publishing node.
+     * @param topic    Topic name relative to the node.
+     * @return The fully qualified topic name "nodeName/topic".
+     */
+    std::string_view Intern(TopicID id, std::string_view nodeName,
+                            std::string_view topic);
+
+    /**
+     * Records the name of a topic which is already fully qualified.
+     *
+     * @param id   The ID of the topic name.
+     * @param name The fully qualified topic name.
+     * @return The interned copy of the name.
+     */
+    std::string_view Intern(TopicID id, std::string_view name);
+
+    /**
+     * Returns the name of the given topic, or an empty string if it was never
+     * interned.
+     *
+     * @param id The topic's ID.
+     */
+    std::string_view GetName(TopicID id) const;
+
+private:
+    struct Entry {
+        std::atomic<TopicID> id{0};
+        std::atomic<bool> ready{false};
+        uint8_t length = 0;
+        char name[kMaxTopicLength];
+
+        std::string_view Name() const { return {name, length}; }
+    };
+
+    std::array<Entry, kMaxTopics> m_entries;
+
+    TopicRegistry() = default;
+
+    /**
+     * Records the name made by joining the given parts.
+     */
+    std::string_view InternParts(TopicID id,
+                                 std::initializer_list<std::string_view> parts);
+};
+
+}  // namespace frc3512
@@ -5,15 +5,17 @@
 #include <stdint.h>
 
 #include <atomic>
-#include <chrono>
 #include <functional>
+#include <map>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <tuple>
 #include <vector>
 
 #include "dsdisplay/Packet.hpp"
+#include "dsdisplay/PacketArena.hpp"
 #include "dsdisplay/UdpSocket.hpp"
 
 namespace frc3512 {
@@ -28,11 +30,25 @@ namespace frc3512 {
  * 2) Call several variations of AddData().
  * 3) After all data is packed, call SendToDS() to send the data to the Driver
  *    Station.
+ *
+ * A Driver Station that connects with "connectCompact\r\n" instead of
+ * "connect\r\n" gets compact frames. Each element name is assigned a small ID
+ * the first time it's added, and the name is only sent in the first frame
+ * after that and in keyframes. Other frames only contain the elements whose
+ * values changed since the last SendToDS(). Doubles are sent in binary rather
+ * than as strings.
  */
 class DSDisplay {
 public:
     enum StatusLight : int8_t { active, standby, inactive };
 
+    /**
+     * Number of frames between keyframes in compact mode. Keyframes contain
+     * every element's name and value, so a Driver Station that missed a frame
+     * catches up within this many frames.
+     */
+    static constexpr int kKeyframeInterval = 50;
+
     explicit DSDisplay(int port);
     ~DSDisplay();
 
@@ -44,12 +60,12 @@ public:
      */
     void Clear();
 
-    void AddData(std::string ID, StatusLight data);
-    void AddData(std::string ID, bool data);
-    void AddData(std::string ID, int8_t data);
-    void AddData(std::string ID, int32_t data);
-    void AddData(std::string ID, std::string data);
-    void AddData(std::string ID, double data);
+    void AddData(std::string_view ID, StatusLight data);
+    void AddData(std::string_view ID, bool data);
+    void AddData(std::string_view ID, int8_t data);
+    void AddData(std::string_view ID, int32_t data);
+    void AddData(std::string_view ID, std::string_view data);
+    void AddData(std::string_view ID, double data);
 
     /**
      * Sends data currently in class's internal packet to Driver Station.
@@ -83,16 +99,60 @@ public:
     void ExecAutonomousPeriodic();
 
 private:
-    using steady_clock = std::chrono::steady_clock;
+    // An element of a compact frame
+    struct Element {
+        std::string name;
+
+        // Type character and value in the format AppendValue() takes
+        int8_t type = 0;
+        std::string value;
+
+        // Whether the name has been sent
+        bool isDefined = false;
+
+        // Whether the value changed since the last frame
+        bool isChanged = false;
+    };
 
     Packet m_packet;
 
-    UdpSocket m_socket;  // socket for sending data to Driver Station
-    uint32_t m_dsIP;     // IP address of Driver Station
-    int m_dsPort;        // port to which to send data
+    // Element IDs by name. std::less<> lets AddData() look up names without
+    // constructing a std::string.
+    std::map<std::string, uint16_t, std::less<>> m_elementIDs;
+
+    // Indexed by element ID
+    std::vector<Element> m_elements;
+
+    // Whether AddData() is building a compact frame. Only changed by
+    // StartFrame().
+    bool m_isCompact = false;
+
+    // Whether AddData() was called since the last SendToDS()
+    bool m_isFrameStarted = false;
 
-    // Rate-limits keepalive
-    steady_clock::time_point m_prevTime = steady_clock::now();
+    // Set by the receive thread when the Driver Station connects
+    std::atomic<bool> m_compactRequested{false};
+    std::atomic<bool> m_keyframeRequested{false};
+
+    // Compact frames left until the next keyframe
+    int m_framesUntilKeyframe = 0;
+
+    // Holds replies built by ReceiveFromDS() that don't fit inline, such as
+    // the autonomous mode list. Reset before each request or keepalive.
+    PacketArena m_arena{4096};
+
+    UdpSocket m_socket;   // socket for sending data to Driver Station
+    uint32_t m_dsIP = 0;  // IP address of Driver Station
+    int m_dsPort;         // port to which to send data
+
+    // The receive thread sleeps in epoll_wait() on these and m_socket
+    int m_epollFd = -1;
+
+    // Expires every 250 ms to send a keepalive
+    int m_keepaliveTimerFd = -1;
+
+    // Written by the destructor to wake the receive thread
+    int m_stopEventFd = -1;
 
     // Stores IP address temporarily during receive
     uint32_t m_recvIP;
@@ -121,9 +181,65 @@ private:
     void SendToDS(Packet& packet);
 
     /**
-     * Receives control commands from Driver Station and processes them.
+     * Picks the format of the frame being built if this is its first element.
+     */
+    void StartFrame();
+
+    /**
+     * Writes an element's value into the packet, or stores it for the next
+     * compact frame if it changed.
+     *
+     * @param ID    The element's name.
+     * @param type  The type character.
+     * @param value The value. Strings ('s') are written length-prefixed and
+     *              anything else is written as raw bytes.
+     */
+    void AddValue(std::string_view ID, int8_t type, std::string_view value);
+
+    /**
+     * Writes a value in the format AddValue() takes into the packet.
+     */
+    static void AppendValue(Packet& packet, int8_t type,
+                            std::string_view value);
+
+    /**
+     * Returns the ID of the element with the given name, adding one if it
+     * doesn't have one yet.
+     */
+    uint16_t InternElement(std::string_view name);
+
+    /**
+     * Writes a compact frame of the elements added since the last one into
+     * m_packet.
+     *
+     * @return False if no element changed, so there's nothing to send.
+     */
+    bool BuildCompactFrame();
+
+    /**
+     * Creates the descriptors the receive thread waits on.
+     *
+     * @return False if one couldn't be created.
+     */
+    bool CreateEventFds();
+
+    /**
+     * Waits for requests from the Driver Station and the keepalive timer and
+     * handles them until the destructor runs.
+     */
+    void RunReceiveLoop();
+
+    /**
+     * Sends a keepalive to Driver Station.
+     */
+    void SendKeepalive();
+
+    /**
+     * Receives one control command from Driver Station and processes it.
+     *
+     * @return False if no command was waiting.
      */
-    void ReceiveFromDS();
+    bool ReceiveFromDS();
 };
 
 }  // namespace frc3512
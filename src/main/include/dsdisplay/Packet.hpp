@@ -1,24 +1,55 @@
-// Copyright (c) 2017-2019 FRC Team 3512. All Rights Reserved.
+// Copyright (c) 2017-2020 FRC Team 3512. All Rights Reserved.
 
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
+#include <memory>
 #include <string>
-#include <vector>
+#include <string_view>
+
+#include "dsdisplay/PacketArena.hpp"
 
 namespace frc3512 {
 
 /**
  * Utility class to build blocks of data to transfer over the network
+ *
+ * Packets up to kInlineSize bytes are stored inside the object, so building
+ * one doesn't allocate. Larger packets spill to the PacketArena given to the
+ * constructor, or to the heap if there isn't one or it's full.
  */
 class Packet {
 public:
+    // Large enough for every generated message type without strings
+    static constexpr size_t kInlineSize = 128;
+
     Packet() = default;
 
+    // Spill data that doesn't fit inline into the given arena. The packet
+    // must not be used after the arena is reset.
+    explicit Packet(PacketArena& arena);
+
+    Packet(const Packet& rhs);
+    Packet(Packet&& rhs) noexcept;
+    Packet& operator=(const Packet& rhs);
+    Packet& operator=(Packet&& rhs) noexcept;
+
     // Append data to the end of the packet
     void append(const void* data, size_t sizeInBytes);
 
+    // Append an array of numbers as one block. Integers are converted to
+    // network byte order in a single pass, and the result matches writing
+    // each element with operator<<. T may be any fixed-width integer of up to
+    // 32 bits, float, or double.
+    template <class T>
+    void appendArray(const T* data, size_t count);
+
+    // Allocate space for the packet to grow to the given size without
+    // reallocating
+    void reserve(size_t sizeInBytes);
+
     // Empty the packet
     void clear();
 
@@ -38,6 +69,12 @@ public:
      */
     size_t getDataSize() const;
 
+    // Extract an array of numbers written by appendArray() or by writing each
+    // element with operator<<. Nothing is extracted unless the whole array
+    // is there.
+    template <class T>
+    Packet& readArray(T* data, size_t count);
+
 public:
     // Overloads of operator<< to write data into the packet
     Packet& operator>>(bool& data);
@@ -60,10 +97,18 @@ public:
     Packet& operator<<(float data);
     Packet& operator<<(double data);
     Packet& operator<<(const std::string& data);
+    Packet& operator<<(std::string_view data);
 
 private:
-    // Data stored in the packet
-    std::vector<char> m_packetData;
+    // Data stored in the packet. Points at m_inline, m_heap, or a block of
+    // m_arena.
+    char* m_data = m_inline;
+    size_t m_size = 0;
+    size_t m_capacity = kInlineSize;
+
+    char m_inline[kInlineSize];
+    std::unique_ptr<char[]> m_heap;
+    PacketArena* m_arena = nullptr;
 
     // Reading state of the packet
     bool m_isValid = true;
@@ -76,6 +121,9 @@ private:
 
     // Checks if the packet can extract a given number of bytes
     bool CheckSize(size_t size);
+
+    // Moves the data to storage that holds at least the given number of bytes
+    void Grow(size_t capacity);
 };
 
 }  // namespace frc3512
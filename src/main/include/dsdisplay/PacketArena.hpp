@@ -0,0 +1,64 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stddef.h>
+
+#include <memory>
+
+namespace frc3512 {
+
+/**
+ * A fixed-size buffer that Packets too large for their inline storage can
+ * allocate from instead of the heap.
+ *
+ * Allocation bumps an offset, and memory is only reclaimed all at once by
+ * Reset(). A loop that builds packets every cycle resets its arena at the
+ * start of each cycle, so after the first cycle none of its packets touch the
+ * heap. Packets allocated from an arena must not be used after it's reset.
+ *
+ * An arena isn't thread-safe. Each thread building packets should have its
+ * own.
+ */
+class PacketArena {
+public:
+    /**
+     * Constructs an arena.
+     *
+     * @param size Size of the arena's buffer in bytes.
+     */
+    explicit PacketArena(size_t size);
+
+    PacketArena(const PacketArena&) = delete;
+    PacketArena& operator=(const PacketArena&) = delete;
+
+    /**
+     * Returns a block of the given size, or nullptr if the arena doesn't have
+     * that much left.
+     *
+     * @param size Size of the block in bytes.
+     */
+    char* Allocate(size_t size);
+
+    /**
+     * Frees every block allocated since the last reset.
+     */
+    void Reset();
+
+    /**
+     * Returns the number of bytes allocated since the last reset.
+     */
+    size_t Used() const;
+
+    /**
+     * Returns the size of the arena's buffer in bytes.
+     */
+    size_t Capacity() const;
+
+private:
+    std::unique_ptr<char[]> m_buffer;
+    size_t m_capacity;
+    size_t m_used = 0;
+};
+
+}  // namespace frc3512
@@ -0,0 +1,112 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string_view>
+
+namespace frc3512 {
+
+class Packet;
+
+/**
+ * Reads the fields of a serialized packet straight out of a buffer it doesn't
+ * own.
+ *
+ * The format matches what Packet's operator<< writes. Unlike Packet's
+ * operator>>, nothing is copied into the reader first and strings are read as
+ * views into the buffer, so the buffer must outlive them.
+ *
+ * Every read is bounds-checked. Once a read runs past the end of the buffer,
+ * the reader becomes invalid and later reads leave their arguments unchanged.
+ */
+class PacketReader {
+public:
+    /**
+     * Constructs a reader over the given buffer.
+     *
+     * @param data The buffer.
+     * @param size The length of the buffer in bytes.
+     */
+    PacketReader(const char* data, size_t size);
+
+    /**
+     * Constructs a reader over the given packet's data.
+     *
+     * @param packet The packet. Must not be modified while the reader is used.
+     */
+    explicit PacketReader(const Packet& packet);
+
+    /**
+     * Returns false if a read ran past the end of the buffer.
+     */
+    explicit operator bool() const;
+
+    /**
+     * Returns the number of bytes left to read.
+     */
+    size_t Remaining() const;
+
+    /**
+     * Returns a view of the next given number of bytes and skips over them.
+     *
+     * @param size The number of bytes.
+     * @return The bytes, or an empty view if there aren't that many left.
+     */
+    std::string_view ReadBytes(size_t size);
+
+    /**
+     * Copies the next sizeof(T) bytes into the given object as is, without
+     * converting byte order.
+     *
+     * @param value A trivially copyable object, such as a packed struct with
+     *              a packet's wire layout.
+     * @return False if there weren't enough bytes left.
+     */
+    template <class T>
+    bool ReadRaw(T& value);
+
+    /**
+     * Reads an array of numbers written by Packet::appendArray() or by
+     * writing each element with Packet's operator<<.
+     *
+     * The whole block is size-checked once and integers are converted from
+     * network byte order in a single pass.
+     *
+     * @param data  Where to store the array. Left unchanged if there aren't
+     *              enough bytes left.
+     * @param count The number of elements.
+     * @return False if there weren't enough bytes left.
+     */
+    template <class T>
+    bool ReadArray(T* data, size_t count);
+
+    PacketReader& operator>>(bool& data);
+    PacketReader& operator>>(int8_t& data);
+    PacketReader& operator>>(uint8_t& data);
+    PacketReader& operator>>(int16_t& data);
+    PacketReader& operator>>(uint16_t& data);
+    PacketReader& operator>>(int32_t& data);
+    PacketReader& operator>>(uint32_t& data);
+    PacketReader& operator>>(float& data);
+    PacketReader& operator>>(double& data);
+    PacketReader& operator>>(std::string_view& data);
+
+private:
+    const char* m_data;
+    size_t m_size;
+
+    // Current reading position in the buffer
+    size_t m_readPos = 0;
+
+    bool m_isValid = true;
+
+    // Checks if the reader can extract a given number of bytes
+    bool CheckSize(size_t size);
+};
+
+}  // namespace frc3512
+
+#include "PacketReader.inc"
@@ -0,0 +1,145 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "dsdisplay/Packet.hpp"
+#include "dsdisplay/PacketReader.hpp"
+
+namespace frc3512 {
+
+/**
+ * Compactly encodes a stream of telemetry frames into Packets.
+ *
+ * A frame is a fixed sequence of numbers, such as one status packet's fields,
+ * sent every control cycle. Each value is encoded against the value in the
+ * same position of the previous frame:
+ *
+ * - Integers are written as the zigzag varint of their difference, so small
+ *   changes take one byte.
+ * - Doubles are XORed with the previous value, like Gorilla does, and only the
+ *   bytes between the leading and trailing zero bytes of the result are
+ *   written after a one-byte header. An unchanged value takes one byte.
+ *
+ * Encoding is lossless. Every keyframeInterval frames, a keyframe is encoded
+ * against zeroes instead, so a decoder that missed a frame can resynchronize.
+ *
+ * Encode values in the same order for every frame. TelemetryDecoder must read
+ * them back in that order too.
+ */
+class TelemetryEncoder {
+public:
+    static constexpr int kDefaultKeyframeInterval = 50;
+
+    /**
+     * Constructs an encoder.
+     *
+     * @param keyframeInterval Number of frames between keyframes, including
+     *                         the keyframe. 1 makes every frame a keyframe.
+     */
+    explicit TelemetryEncoder(int keyframeInterval = kDefaultKeyframeInterval);
+
+    /**
+     * Writes the header of a new frame into the packet.
+     *
+     * @param packet The packet to write to.
+     */
+    void BeginFrame(Packet& packet);
+
+    /**
+     * Makes the next frame a keyframe, such as when a new decoder connects.
+     */
+    void ForceKeyframe();
+
+    /**
+     * Writes the next integer of the frame into the packet.
+     *
+     * @param packet The packet to write to.
+     * @param value  The value.
+     */
+    void EncodeInteger(Packet& packet, int64_t value);
+
+    /**
+     * Writes the next double of the frame into the packet.
+     *
+     * @param packet The packet to write to.
+     * @param value  The value.
+     */
+    void EncodeDouble(Packet& packet, double value);
+
+private:
+    int m_keyframeInterval;
+    int m_framesUntilKeyframe = 0;
+    uint32_t m_sequence = 0;
+    bool m_isKeyframe = true;
+
+    // The previous frame's values as raw bits, indexed by position
+    std::vector<uint64_t> m_previous;
+    size_t m_position = 0;
+
+    /**
+     * Returns the previous frame's value in the next position, which is zero
+     * for keyframes, and replaces it with the given one.
+     */
+    uint64_t Exchange(uint64_t value);
+};
+
+/**
+ * Decodes frames written by TelemetryEncoder.
+ */
+class TelemetryDecoder {
+public:
+    /**
+     * Reads the header of the next frame.
+     *
+     * @param reader The reader positioned at the frame.
+     * @return False if the frame can't be decoded because the header is cut
+     *         off or a frame since the last keyframe was missed. Such frames
+     *         should be skipped until a keyframe arrives.
+     */
+    bool BeginFrame(PacketReader& reader);
+
+    /**
+     * Reads the next integer of the frame.
+     *
+     * @param reader The reader positioned at the value.
+     * @param value  Set to the value. Left unchanged on failure.
+     * @return False if the value is cut off.
+     */
+    bool DecodeInteger(PacketReader& reader, int64_t& value);
+
+    /**
+     * Reads the next double of the frame.
+     *
+     * @param reader The reader positioned at the value.
+     * @param value  Set to the value. Left unchanged on failure.
+     * @return False if the value is cut off or malformed.
+     */
+    bool DecodeDouble(PacketReader& reader, double& value);
+
+private:
+    // True once a keyframe has been decoded and no frame was missed since
+    bool m_isSynced = false;
+    uint32_t m_sequence = 0;
+    bool m_isKeyframe = false;
+
+    std::vector<uint64_t> m_previous;
+    size_t m_position = 0;
+
+    /**
+     * Returns the previous frame's value in the next position, which is zero
+     * for keyframes.
+     */
+    uint64_t Previous();
+
+    /**
+     * Stores the decoded value for the position Previous() returned.
+     */
+    void Store(uint64_t value);
+};
+
+}  // namespace frc3512
@@ -136,6 +136,13 @@ public:
      */
     bool isBlocking() const;
 
+    /**
+     * Get the socket's file descriptor, such as for waiting on it with epoll
+     *
+     * @return The descriptor, or -1 if the socket hasn't been created
+     */
+    int getHandle() const;
+
 private:
     int m_socket = -1;        // Socket descriptor
     bool m_isBlocking{true};  // Current blocking mode of the socket
@@ -1,4 +1,4 @@
-// Copyright (c) 2014-2019 FRC Team 3512. All Rights Reserved.
+// Copyright (c) 2014-2020 FRC Team 3512. All Rights Reserved.
 
 #pragma once
 
@@ -6,6 +6,8 @@
 #include <string>
 #include <vector>
 
+#include <wpi/mutex.h>
+
 #include "communications/PublishNode.hpp"
 #include "logging/LogEvent.hpp"
 #include "logging/LogSinkBase.hpp"
@@ -32,10 +34,19 @@ public:
      * Logs an event to all registered LogSinkBase sinks whose verbosity levels
      * contain that of the event (see LogSinkBase::TestVerbosityLevel()).
      *
+     * This may be called from any thread.
+     *
      * @param event The event to log.
      */
     void Log(LogEvent event) override;
 
+    /**
+     * Logs a summary of a PublishNode's statistics at VERBOSE_INFO.
+     *
+     * @param stats Statistics from PublishNode::GetStats().
+     */
+    void LogNodeStats(const NodeStatsSnapshot& stats);
+
     /**
      * Registers a sink for log events with the logging engine.
      *
@@ -84,6 +95,10 @@ public:
 private:
     LogSinkBaseList m_sinkList;
     std::time_t m_initialTime;
+
+    // Serializes access to the sinks, since they're shared by every thread
+    // that logs
+    mutable wpi::mutex m_sinkMutex;
 };
 
 }  // namespace frc3512
@@ -3,7 +3,7 @@
 #pragma once
 
 #include <atomic>
-#include <mutex>
+#include <chrono>
 
 #include <frc/Encoder.h>
 #include <frc/PowerDistributionPanel.h>
@@ -37,6 +37,8 @@ public:
      */
     explicit Climber(frc::PowerDistributionPanel& pdp);
 
+    ~Climber() override;
+
     /**
      * Sets the voltage to pass into the drive motor.
      *
@@ -103,15 +105,25 @@ public:
      */
     void Reset();
 
-    void ProcessMessage(const CommandPacket& message) override;
-
-    void ProcessMessage(const ButtonPacket& message) override;
+    /**
+     * Sets how long the Elevator and FourBarLift get to reach each climbing
+     * goal. If one doesn't reply in time, the climb is abandoned and the state
+     * machine returns to State::kInit. The default is five seconds.
+     *
+     * This should be called before a climb starts.
+     *
+     * @param timeout The timeout.
+     */
+    void SetGoalTimeout(std::chrono::nanoseconds timeout);
 
-    void ProcessMessage(const HIDPacket& message) override;
+    /**
+     * Returns the climbing state machine's state.
+     */
+    State GetState() const;
 
-    void ProcessMessage(const ElevatorStatusPacket& message) override;
+    void ProcessMessage(const CommandPacket& message) override;
 
-    void ProcessMessage(const FourBarLiftStatusPacket& message) override;
+    void ProcessMessage(const ButtonPacket& message) override;
 
     /**
      * Runs a state machine to climb onto platform upon button press
@@ -119,11 +131,21 @@ public:
      * The beginning state is the robot on platform level one, up against the
      * level 3 platform. The end state should be the robot on top of the level 3
      * platform with the lift retracted.
+     *
+     * The Elevator and FourBarLift are sent requests and reply when they
+     * reach the goals the climb needs, so each step starts as soon as the
+     * previous one finishes. Joystick state is read from the Blackboard.
+     *
+     * A step is only taken if the previous one left the mechanism where the
+     * climb needs it, so the climb returns to State::kInit if the Elevator
+     * stops too low or the FourBarLift too high.
      */
     void SubsystemPeriodic() override;
 
 private:
-    State m_state = State::kInit;
+    // Written by request callbacks on the node's thread as well as by
+    // SubsystemPeriodic()
+    std::atomic<State> m_state{State::kInit};
 
     frc::Spark m_lift{Constants::Climber::kLiftPort};
     frc::Spark m_drive{Constants::Climber::kDrivePort};
@@ -132,6 +154,8 @@ private:
     double lastVelocity;
     bool m_thirdLevel = true;
 
+    std::chrono::nanoseconds m_goalTimeout = std::chrono::seconds{5};
+
     ClimberController m_controller;
 
     frc::Encoder m_encoder{Constants::Climber::kLiftEncoderA,
@@ -139,13 +163,35 @@ private:
     frc::RTNotifier m_notifier{Constants::kControllerPrio, &Climber::Iterate,
                                this};
 
-    ElevatorStatusPacket m_elevatorStatusPacket;
-    FourBarLiftStatusPacket m_fourBarLiftStatusPacket;
-    HIDPacket m_HIDPacket;
-    ButtonPacket m_buttonPacket;
-    std::mutex m_cacheMutex;
+    // The last climbing button pressed on AppendageStick2 which the state
+    // machine hasn't acted on yet, or zero
+    std::atomic<int> m_pressedButton{0};
 
     frc::PowerDistributionPanel& m_pdp;
+
+    /**
+     * Returns true and clears the pending button press if it's the given
+     * button.
+     *
+     * @param button The button number.
+     */
+    bool ConsumeButtonPress(int button);
+
+    /**
+     * Asks the FourBarLift to lower once the Elevator has reached climbing
+     * height.
+     *
+     * @param reply The Elevator's reply, or nullptr if it timed out.
+     */
+    void OnElevatorRaised(const CommandPacket* reply);
+
+    /**
+     * Starts lowering the climber once the FourBarLift has reached its
+     * climbing angle.
+     *
+     * @param reply The FourBarLift's reply, or nullptr if it timed out.
+     */
+    void OnFourBarLowered(const CommandPacket* reply);
 };
 
 }  // namespace frc3512
@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include <stdint.h>
+
 #include <atomic>
 
 #include <frc/Encoder.h>
@@ -95,7 +97,8 @@ public:
     void Reset();
 
     /**
-     * Publishes status packets.
+     * Publishes status packets and passes a reached goal to the node's thread
+     * so it replies to the request that set it.
      */
     void SubsystemPeriodic() override;
 
@@ -115,6 +118,13 @@ private:
                              this};
 
     std::atomic<bool> m_isEnabled{true};
+
+    // requestID of the command that set the current goal, or zero. Replied to
+    // when the goal is reached.
+    std::atomic<uint32_t> m_goalRequestID{0};
+
+    // Set by Iterate() when the requested goal is reached
+    std::atomic<bool> m_isGoalReached{false};
 };
 
 }  // namespace frc3512
@@ -2,6 +2,10 @@
 
 #pragma once
 
+#include <stdint.h>
+
+#include <atomic>
+
 #include <frc/Encoder.h>
 #include <frc/RTNotifier.h>
 #include <frc/SpeedControllerGroup.h>
@@ -76,7 +80,8 @@ public:
     void Reset();
 
     /**
-     * Publishes status packets.
+     * Publishes status packets and passes a reached goal to the node's thread
+     * so it replies to the request that set it.
      */
     void SubsystemPeriodic() override;
 
@@ -93,6 +98,13 @@ private:
 
     frc::RTNotifier m_thread{Constants::kControllerPrio, &FourBarLift::Iterate,
                              this};
+
+    // requestID of the command that set the current goal, or zero. Replied to
+    // when the goal is reached.
+    std::atomic<uint32_t> m_goalRequestID{0};
+
+    // Set by Iterate() when the requested goal is reached
+    std::atomic<bool> m_isGoalReached{false};
 };
 
 }  // namespace frc3512
@@ -0,0 +1,72 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <atomic>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "communications/Blackboard.hpp"
+
+using namespace frc3512;
+
+TEST(BlackboardTest, ReadsLatestPacket) {
+    auto& blackboard = Blackboard::GetInstance();
+
+    ElevatorStatusPacket status;
+    EXPECT_FALSE(blackboard.Read("BlackboardTest/Status"_topic, status));
+
+    ElevatorStatusPacket first{"", 0.1, 1.0, false, false};
+    first.topicID = "BlackboardTest/Status"_topic;
+    blackboard.Write(first);
+    ElevatorStatusPacket second{"", 0.2, 2.0, true, true};
+    second.topicID = "BlackboardTest/Status"_topic;
+    blackboard.Write(second);
+
+    ASSERT_TRUE(blackboard.Read("BlackboardTest/Status"_topic, status));
+    EXPECT_EQ(status.distance, 0.2);
+    EXPECT_EQ(status.controllerVoltage, 2.0);
+    EXPECT_TRUE(status.atReference);
+    EXPECT_TRUE(status.atGoal);
+
+    // The topic holds a different packet type
+    FourBarLiftStatusPacket wrongType;
+    EXPECT_FALSE(blackboard.Read("BlackboardTest/Status"_topic, wrongType));
+}
+
+TEST(BlackboardTest, ReadsAreConsistentDuringWrites) {
+    auto& blackboard = Blackboard::GetInstance();
+    std::atomic<bool> isRunning{true};
+
+    HIDPacket hid;
+    hid.topicID = "BlackboardTest/HID"_topic;
+    blackboard.Write(hid);
+
+    // Every packet written has all axes equal, so a torn read would show up as
+    // a mismatch
+    std::thread writer([&, hid]() mutable {
+        for (int i = 0; isRunning; ++i) {
+            hid.x.fill(i);
+            hid.y.fill(i);
+            hid.buttons.fill(i);
+            blackboard.Write(hid);
+        }
+    });
+
+    int reads = 0;
+    int tornReads = 0;
+    for (int i = 0; i < 100000; ++i) {
+        if (blackboard.Read("BlackboardTest/HID"_topic, hid)) {
+            ++reads;
+            if (hid.x[0] != hid.y[3] || hid.y[0] != hid.x[1] ||
+                hid.buttons[0] != hid.buttons[3] ||
+                hid.x[0] != hid.buttons[3]) {
+                ++tornReads;
+            }
+        }
+    }
+
+    isRunning = false;
+    writer.join();
+    EXPECT_GT(reads, 0);
+    EXPECT_EQ(tornReads, 0);
+}
@@ -0,0 +1,205 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <frc/PowerDistributionPanel.h>
+#include <gtest/gtest.h>
+
+#include "communications/PublishNode.hpp"
+#include "subsystems/Climber.hpp"
+
+using namespace frc3512;
+
+namespace {
+
+/**
+ * Stands in for the Elevator or FourBarLift during a climb.
+ *
+ * Like the real subsystem, it publishes its status and then replies when it
+ * receives the climbing command it handles, unless it's stalled.
+ */
+template <class StatusPacket>
+class MechanismNode : public PublishNode {
+public:
+    /**
+     * Constructs a MechanismNode.
+     *
+     * @param name     The name of the subsystem it stands in for.
+     * @param command  The topic of the command it replies to.
+     * @param distance The distance its status reports once it replies.
+     */
+    MechanismNode(std::string_view name, TopicID command, double distance)
+        : PublishNode(name), m_command{command}, m_distance{distance} {}
+
+    ~MechanismNode() override { Stop(); }
+
+    void ProcessMessage(const CommandPacket& message) override {
+        {
+            std::lock_guard lock(m_mutex);
+            m_commands.emplace_back(message.topic);
+        }
+
+        if (message.topicID == m_command && !m_isStalled) {
+            Publish(StatusPacket{"Status", m_distance, 0.0, true, true});
+            Reply(message.requestID);
+        }
+    }
+
+    /**
+     * Makes the node ignore its command, so the request times out.
+     */
+    void Stall() { m_isStalled = true; }
+
+    /**
+     * Returns true if a command on the given topic was received.
+     */
+    bool HasReceived(std::string_view topic) {
+        std::lock_guard lock(m_mutex);
+        return std::find(m_commands.begin(), m_commands.end(), topic) !=
+               m_commands.end();
+    }
+
+    /**
+     * Waits up to one second for a command on the given topic.
+     */
+    bool WaitForCommand(std::string_view topic) {
+        for (int i = 0; i < 1000; ++i) {
+            if (HasReceived(topic)) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    }
+
+private:
+    TopicID m_command;
+    double m_distance;
+    std::atomic<bool> m_isStalled{false};
+
+    std::mutex m_mutex;
+    std::vector<std::string> m_commands;
+};
+
+using ElevatorNode = MechanismNode<ElevatorStatusPacket>;
+using FourBarLiftNode = MechanismNode<FourBarLiftStatusPacket>;
+
+/**
+ * Runs the Climber's state machine every 20 ms, like its Notifier does, until
+ * the condition holds or a second passes.
+ */
+template <class F>
+bool RunUntil(Climber& climber, F&& condition) {
+    for (int i = 0; i < 50; ++i) {
+        if (condition()) {
+            return true;
+        }
+        climber.SubsystemPeriodic();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    return condition();
+}
+
+/**
+ * Runs the Climber's state machine until it reaches the given state or a
+ * second passes.
+ */
+bool RunUntil(Climber& climber, State state) {
+    return RunUntil(climber, [&] { return climber.GetState() == state; });
+}
+
+/**
+ * Connects the stand-ins to the Climber the way Robot connects the real
+ * subsystems.
+ */
+void Connect(Climber& climber, ElevatorNode& elevator,
+             FourBarLiftNode& fourBarLift) {
+    climber.Subscribe(elevator,
+                      {{PacketType::kCommand}, {"Elevator/Reply"_topic}});
+    climber.Subscribe(fourBarLift,
+                      {{PacketType::kCommand}, {"FourBarLift/Reply"_topic}});
+    elevator.Subscribe(climber, {PacketType::kCommand});
+    fourBarLift.Subscribe(climber, {PacketType::kCommand});
+}
+
+}  // namespace
+
+TEST(ClimberTest, ClimbsThirdLevel) {
+    frc::PowerDistributionPanel pdp;
+    Climber climber{pdp};
+    ElevatorNode elevator{"Elevator", "Climber/ThirdLevel"_topic, 0.42};
+    FourBarLiftNode fourBarLift{"FourBarLift", "Climber/FourBarStart"_topic,
+                                -1.35};
+    Connect(climber, elevator, fourBarLift);
+
+    climber.PushMessage(ButtonPacket{"Robot/AppendageStick2", 7, true});
+
+    // The Elevator's reply starts the FourBarLift, whose reply starts the
+    // descent
+    ASSERT_TRUE(RunUntil(climber, State::kDescend));
+    EXPECT_TRUE(elevator.HasReceived("Climber/ThirdLevel"));
+    EXPECT_TRUE(fourBarLift.HasReceived("Climber/FourBarStart"));
+    EXPECT_TRUE(elevator.WaitForCommand("Climber/ClimbingProfile"));
+    EXPECT_TRUE(elevator.WaitForCommand("Climber/Down3"));
+}
+
+TEST(ClimberTest, AbortsIfElevatorStopsTooLow) {
+    frc::PowerDistributionPanel pdp;
+    Climber climber{pdp};
+    ElevatorNode elevator{"Elevator", "Climber/ThirdLevel"_topic, 0.2};
+    FourBarLiftNode fourBarLift{"FourBarLift", "Climber/FourBarStart"_topic,
+                                -1.35};
+    Connect(climber, elevator, fourBarLift);
+
+    climber.PushMessage(ButtonPacket{"Robot/AppendageStick2", 7, true});
+    ASSERT_TRUE(RunUntil(
+        climber, [&] { return elevator.HasReceived("Climber/ThirdLevel"); }));
+
+    // The reply arrives, but the Elevator is below the third level
+    EXPECT_TRUE(RunUntil(climber, State::kInit));
+    EXPECT_FALSE(fourBarLift.HasReceived("Climber/FourBarStart"));
+}
+
+TEST(ClimberTest, AbortsIfElevatorTimesOut) {
+    frc::PowerDistributionPanel pdp;
+    Climber climber{pdp};
+    climber.SetGoalTimeout(std::chrono::milliseconds(50));
+    ElevatorNode elevator{"Elevator", "Climber/ThirdLevel"_topic, 0.42};
+    FourBarLiftNode fourBarLift{"FourBarLift", "Climber/FourBarStart"_topic,
+                                -1.35};
+    Connect(climber, elevator, fourBarLift);
+    elevator.Stall();
+
+    climber.PushMessage(ButtonPacket{"Robot/AppendageStick2", 7, true});
+    ASSERT_TRUE(RunUntil(
+        climber, [&] { return elevator.HasReceived("Climber/ThirdLevel"); }));
+
+    EXPECT_TRUE(RunUntil(climber, State::kInit));
+    EXPECT_FALSE(fourBarLift.HasReceived("Climber/FourBarStart"));
+}
+
+TEST(ClimberTest, AbortsIfFourBarLiftTimesOut) {
+    frc::PowerDistributionPanel pdp;
+    Climber climber{pdp};
+    climber.SetGoalTimeout(std::chrono::milliseconds(50));
+    ElevatorNode elevator{"Elevator", "Climber/ThirdLevel"_topic, 0.42};
+    FourBarLiftNode fourBarLift{"FourBarLift", "Climber/FourBarStart"_topic,
+                                -1.35};
+    Connect(climber, elevator, fourBarLift);
+    fourBarLift.Stall();
+
+    climber.PushMessage(ButtonPacket{"Robot/AppendageStick2", 7, true});
+    ASSERT_TRUE(RunUntil(climber, [&] {
+        return fourBarLift.HasReceived("Climber/FourBarStart");
+    }));
+
+    EXPECT_TRUE(RunUntil(climber, State::kInit));
+    EXPECT_FALSE(elevator.HasReceived("Climber/Down3"));
+}
@@ -0,0 +1,332 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "dsdisplay/DSDisplay.hpp"
+#include "dsdisplay/PacketReader.hpp"
+#include "dsdisplay/UdpSocket.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr uint32_t kLoopback = 0x7F000001;
+constexpr uint16_t kRobotPort = 5810;
+constexpr uint16_t kDSPort = 5811;
+
+// A record of a compact frame
+struct Record {
+    char type;
+    uint16_t ID;
+
+    // The name of 'n' records and the value bytes of the rest
+    std::string data;
+};
+
+struct CompactFrame {
+    bool isKeyframe;
+    std::vector<Record> records;
+
+    /**
+     * Returns the records of the given type.
+     */
+    std::vector<Record> Find(char type) const {
+        std::vector<Record> found;
+        std::copy_if(records.begin(), records.end(), std::back_inserter(found),
+                     [&](const auto& record) { return record.type == type; });
+        return found;
+    }
+};
+
+/**
+ * Plays the Driver Station's side of the protocol over loopback.
+ */
+class FakeDS {
+public:
+    FakeDS() {
+        m_socket.bind(kDSPort);
+        m_socket.setBlocking(false);
+    }
+
+    void Send(std::string_view command) {
+        m_socket.send(command.data(), command.size(), kLoopback, kRobotPort);
+    }
+
+    /**
+     * Waits for a datagram other than a keepalive.
+     *
+     * @param timeout How long to wait.
+     * @return The datagram, or std::nullopt if none arrived in time.
+     */
+    std::optional<std::string> Receive(
+        std::chrono::milliseconds timeout = 1s) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (std::chrono::steady_clock::now() < deadline) {
+            char buf[2048];
+            size_t received;
+            uint32_t ip;
+            uint16_t port;
+            if (m_socket.receive(buf, sizeof(buf), received, ip, port) !=
+                UdpSocket::Done) {
+                std::this_thread::sleep_for(100us);
+                continue;
+            }
+
+            std::string datagram{buf, received};
+            if (Header(datagram) != "\r\n") {
+                return datagram;
+            }
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * Sends a connect command and waits for the three handshake replies.
+     */
+    bool Connect(std::string_view command) {
+        Send(command);
+        for (std::string_view expected :
+             {"guiCreate\r\n", "autonList\r\n", "autonConfirmed\r\n"}) {
+            auto reply = Receive();
+            if (!reply || Header(*reply) != expected) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Returns the length-prefixed string a datagram starts with.
+     */
+    static std::string_view Header(std::string_view datagram) {
+        frc3512::PacketReader reader{datagram.data(), datagram.size()};
+        std::string_view header;
+        reader >> header;
+        return header;
+    }
+
+    /**
+     * Parses a compact frame, or returns std::nullopt if the datagram isn't
+     * one.
+     */
+    static std::optional<CompactFrame> ParseCompact(std::string_view datagram) {
+        frc3512::PacketReader reader{datagram.data(), datagram.size()};
+        std::string_view header;
+        uint8_t isKeyframe;
+        reader >> header >> isKeyframe;
+        if (!reader || header != "displayCompact\r\n") {
+            return std::nullopt;
+        }
+
+        CompactFrame frame{isKeyframe != 0, {}};
+        while (reader && reader.Remaining() > 0) {
+            int8_t type;
+            Record record;
+            reader >> type >> record.ID;
+            record.type = type;
+
+            std::string_view data;
+            switch (type) {
+                case 'n':
+                case 's':
+                    reader >> data;
+                    break;
+                case 'c':
+                    data = reader.ReadBytes(1);
+                    break;
+                case 'i':
+                    data = reader.ReadBytes(4);
+                    break;
+                case 'd':
+                    data = reader.ReadBytes(8);
+                    break;
+                default:
+                    return std::nullopt;
+            }
+            if (!reader) {
+                return std::nullopt;
+            }
+            record.data = data;
+            frame.records.push_back(record);
+        }
+        return frame;
+    }
+
+private:
+    using UdpSocket = frc3512::UdpSocket;
+
+    UdpSocket m_socket;
+};
+
+/**
+ * Adds the same three elements to every frame.
+ */
+void AddElements(frc3512::DSDisplay& display, double speed) {
+    display.AddData("ENABLED", true);
+    display.AddData("COUNT", static_cast<int32_t>(7));
+    display.AddData("SPEED", speed);
+}
+
+void AddAutoModes(frc3512::DSDisplay& display) {
+    display.AddAutoMethod(
+        "Left", [] {}, [] {});
+    display.AddAutoMethod(
+        "Right", [] {}, [] {});
+}
+
+}  // namespace
+
+TEST(DSDisplayTest, DestructorStopsReceiveThreadPromptly) {
+    auto display = std::make_unique<frc3512::DSDisplay>(kRobotPort);
+
+    // The receive thread is asleep in epoll_wait() with the keepalive timer
+    // 250 ms away, so only the stop eventfd can wake it this quickly
+    std::this_thread::sleep_for(20ms);
+    auto start = std::chrono::steady_clock::now();
+    display.reset();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 100ms);
+}
+
+TEST(DSDisplayTest, RepliesToConnectImmediately) {
+    frc3512::DSDisplay display{kRobotPort};
+    AddAutoModes(display);
+    FakeDS ds;
+
+    // A polling receive thread would add up to a poll interval to each
+    // handshake
+    std::vector<std::chrono::steady_clock::duration> latencies;
+    for (int i = 0; i < 5; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        ASSERT_TRUE(ds.Connect("connect\r\n"));
+        latencies.push_back(std::chrono::steady_clock::now() - start);
+    }
+    std::sort(latencies.begin(), latencies.end());
+    EXPECT_LT(latencies[latencies.size() / 2], 3ms);
+}
+
+TEST(DSDisplayTest, CompactFramesSendOnlyChanges) {
+    frc3512::DSDisplay display{kRobotPort};
+    AddAutoModes(display);
+    FakeDS ds;
+    ASSERT_TRUE(ds.Connect("connectCompact\r\n"));
+
+    // The first frame is a keyframe which names every element
+    AddElements(display, 1.5);
+    display.SendToDS();
+    auto datagram = ds.Receive();
+    ASSERT_TRUE(datagram);
+    auto frame = FakeDS::ParseCompact(*datagram);
+    ASSERT_TRUE(frame);
+    EXPECT_TRUE(frame->isKeyframe);
+
+    auto names = frame->Find('n');
+    ASSERT_EQ(names.size(), 3u);
+    EXPECT_EQ(names[0].data, "ENABLED");
+    EXPECT_EQ(names[1].data, "COUNT");
+    EXPECT_EQ(names[2].data, "SPEED");
+    EXPECT_EQ(frame->Find('c').size(), 1u);
+    EXPECT_EQ(frame->Find('i').size(), 1u);
+    EXPECT_EQ(frame->Find('d').size(), 1u);
+    uint16_t speedID = names[2].ID;
+
+    // Nothing changed, so nothing is sent
+    AddElements(display, 1.5);
+    display.SendToDS();
+    EXPECT_FALSE(ds.Receive(50ms));
+
+    // Only the changed double is sent, as 8 binary bytes
+    AddElements(display, -2.25);
+    display.SendToDS();
+    datagram = ds.Receive();
+    ASSERT_TRUE(datagram);
+    frame = FakeDS::ParseCompact(*datagram);
+    ASSERT_TRUE(frame);
+    EXPECT_FALSE(frame->isKeyframe);
+    ASSERT_EQ(frame->records.size(), 1u);
+    EXPECT_EQ(frame->records[0].type, 'd');
+    EXPECT_EQ(frame->records[0].ID, speedID);
+    ASSERT_EQ(frame->records[0].data.size(), sizeof(double));
+    double speed;
+    std::memcpy(&speed, frame->records[0].data.data(), sizeof(speed));
+    EXPECT_EQ(speed, -2.25);
+}
+
+TEST(DSDisplayTest, CompactKeyframesRepeat) {
+    frc3512::DSDisplay display{kRobotPort};
+    AddAutoModes(display);
+    FakeDS ds;
+    ASSERT_TRUE(ds.Connect("connectCompact\r\n"));
+
+    // Change the speed every frame so every frame is sent
+    for (int i = 0; i <= frc3512::DSDisplay::kKeyframeInterval; ++i) {
+        AddElements(display, i);
+        display.SendToDS();
+
+        auto datagram = ds.Receive();
+        ASSERT_TRUE(datagram);
+        auto frame = FakeDS::ParseCompact(*datagram);
+        ASSERT_TRUE(frame);
+
+        bool isKeyframe =
+            i % frc3512::DSDisplay::kKeyframeInterval == 0;
+        EXPECT_EQ(frame->isKeyframe, isKeyframe) << "frame " << i;
+        EXPECT_EQ(frame->Find('n').size(), isKeyframe ? 3u : 0u)
+            << "frame " << i;
+        EXPECT_EQ(frame->records.size(), isKeyframe ? 6u : 1u)
+            << "frame " << i;
+    }
+}
+
+TEST(DSDisplayTest, ReconnectingSwitchesBackToLegacyFrames) {
+    frc3512::DSDisplay display{kRobotPort};
+    AddAutoModes(display);
+    FakeDS ds;
+
+    ASSERT_TRUE(ds.Connect("connectCompact\r\n"));
+    AddElements(display, 1.5);
+    display.SendToDS();
+    auto datagram = ds.Receive();
+    ASSERT_TRUE(datagram);
+    EXPECT_EQ(FakeDS::Header(*datagram), "displayCompact\r\n");
+
+    ASSERT_TRUE(ds.Connect("connect\r\n"));
+    AddElements(display, 1.5);
+    display.SendToDS();
+    datagram = ds.Receive();
+    ASSERT_TRUE(datagram);
+    EXPECT_EQ(FakeDS::Header(*datagram), "display\r\n");
+
+    // Legacy frames send every element each time, with doubles as strings
+    frc3512::PacketReader reader{datagram->data(), datagram->size()};
+    std::string_view header;
+    reader >> header;
+    int8_t type;
+    std::string_view name;
+    reader >> type >> name;
+    EXPECT_EQ(type, 'c');
+    EXPECT_EQ(name, "ENABLED");
+    reader.ReadBytes(1);
+    reader >> type >> name;
+    EXPECT_EQ(name, "COUNT");
+    reader.ReadBytes(4);
+    std::string_view speed;
+    reader >> type >> name >> speed;
+    EXPECT_EQ(type, 's');
+    EXPECT_EQ(name, "SPEED");
+    EXPECT_EQ(speed, std::to_string(1.5));
+    EXPECT_TRUE(reader);
+    EXPECT_EQ(reader.Remaining(), 0u);
+}
@@ -0,0 +1,178 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "communications/Executor.hpp"
+#include "communications/PublishNode.hpp"
+#include "communications/Strand.hpp"
+
+namespace {
+
+/**
+ * Outlives a TestStrand to record whether it was used after being closed.
+ */
+struct CloseProbe {
+    std::atomic<bool> isClosed{false};
+    std::atomic<bool> wasUsedAfterClose{false};
+};
+
+/**
+ * Counts batches and, if asked, stalls in HasWork() after a batch so a test
+ * can close the strand while a worker is still in Run().
+ */
+class TestStrand : public frc3512::Strand {
+public:
+    explicit TestStrand(frc3512::Executor& executor,
+                        CloseProbe* probe = nullptr)
+        : Strand(executor), m_probe(probe) {}
+
+    ~TestStrand() override {
+        Close();
+        if (m_probe != nullptr) {
+            m_probe->isClosed = true;
+        }
+    }
+
+    void AddWork() {
+        m_pending.fetch_add(1, std::memory_order_relaxed);
+        Notify();
+    }
+
+    /**
+     * Makes HasWork() sleep for the given time before returning.
+     */
+    void StallHasWork(std::chrono::milliseconds duration) {
+        m_stall = duration;
+    }
+
+    /**
+     * Waits up to one second for the given number of batches.
+     */
+    bool WaitForBatches(int count) const {
+        for (int i = 0; i < 1000 && m_batches < count; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return m_batches >= count;
+    }
+
+protected:
+    void RunBatch() override {
+        if (m_pending.load(std::memory_order_relaxed) > 0) {
+            m_pending.fetch_sub(1, std::memory_order_relaxed);
+        }
+        ++m_batches;
+    }
+
+    bool HasWork() const override {
+        std::this_thread::sleep_for(m_stall.load());
+        if (m_probe != nullptr && m_probe->isClosed) {
+            m_probe->wasUsedAfterClose = true;
+        }
+        return m_pending.load(std::memory_order_relaxed) > 0;
+    }
+
+private:
+    std::atomic<int> m_pending{0};
+    std::atomic<int> m_batches{0};
+    std::atomic<std::chrono::milliseconds> m_stall{
+        std::chrono::milliseconds{0}};
+    CloseProbe* m_probe;
+};
+
+class SinkNode : public frc3512::PublishNode {
+public:
+    SinkNode(std::string_view name, frc3512::Executor& executor)
+        : PublishNode(name, executor) {}
+
+    ~SinkNode() override { Stop(); }
+
+    void ProcessMessage(const frc3512::ButtonPacket& message) override {
+        ++m_received;
+    }
+
+private:
+    std::atomic<int> m_received{0};
+};
+
+}  // namespace
+
+TEST(ExecutorTest, RunsEveryStrand) {
+    frc3512::Executor executor{2, 0};
+    std::vector<std::unique_ptr<TestStrand>> strands;
+    for (int i = 0; i < 8; ++i) {
+        strands.emplace_back(std::make_unique<TestStrand>(executor));
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        for (auto& strand : strands) {
+            strand->AddWork();
+        }
+    }
+
+    for (auto& strand : strands) {
+        EXPECT_TRUE(strand->WaitForBatches(3));
+    }
+}
+
+TEST(ExecutorTest, CloseWaitsForRunningWorker) {
+    frc3512::Executor executor{1, 0};
+    CloseProbe probe;
+    auto strand = std::make_unique<TestStrand>(executor, &probe);
+
+    // The worker clears the scheduled flag before calling HasWork(), so the
+    // strand is destroyed while the worker is stalled there. Close() must
+    // wait for HasWork() to return.
+    strand->StallHasWork(std::chrono::milliseconds{50});
+    strand->AddWork();
+    ASSERT_TRUE(strand->WaitForBatches(1));
+    strand.reset();
+
+    // Give a worker still in HasWork() time to see the strand closed
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    EXPECT_FALSE(probe.wasUsedAfterClose);
+}
+
+TEST(ExecutorTest, DestroysNodesWhilePublishing) {
+    frc3512::Executor executor{2, 0};
+
+    for (int i = 0; i < 50; ++i) {
+        auto node = std::make_unique<SinkNode>("Sink", executor);
+
+        std::atomic<bool> isPublishing{true};
+        std::thread publisher{[&] {
+            for (int j = 0; isPublishing; ++j) {
+                node->PushMessage(frc3512::ButtonPacket{"Stick", j, true});
+            }
+        }};
+
+        std::this_thread::sleep_for(std::chrono::microseconds{200});
+        isPublishing = false;
+        publisher.join();
+
+        // The node's queue is still full, so a worker is likely in Run()
+        node.reset();
+    }
+}
+
+TEST(ExecutorTest, StrandsAreCounted) {
+    frc3512::Executor executor{1, 0};
+    std::vector<std::unique_ptr<TestStrand>> strands;
+    for (int i = 0; i < frc3512::Executor::kMaxStrands; ++i) {
+        strands.emplace_back(std::make_unique<TestStrand>(executor));
+    }
+
+    // Destroying strands frees their slots for new ones
+    strands.clear();
+    for (int i = 0; i < frc3512::Executor::kMaxStrands; ++i) {
+        strands.emplace_back(std::make_unique<TestStrand>(executor));
+    }
+
+    ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+    EXPECT_DEATH(TestStrand{executor}, "strands constructed");
+}
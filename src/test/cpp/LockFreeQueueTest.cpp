@@ -0,0 +1,125 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <array>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "communications/LockFreeQueue.hpp"
+
+TEST(LockFreeQueueTest, RoundsCapacityUpToPowerOfTwo) {
+    frc3512::LockFreeQueue<int> queue{5};
+    EXPECT_EQ(queue.Capacity(), 8u);
+}
+
+TEST(LockFreeQueueTest, PreservesOrderAndRejectsWhenFull) {
+    frc3512::LockFreeQueue<int> queue{4};
+    EXPECT_TRUE(queue.Empty());
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.Emplace(i));
+    }
+    EXPECT_FALSE(queue.Emplace(4));
+
+    for (int i = 0; i < 4; ++i) {
+        int value = -1;
+        EXPECT_TRUE(queue.Pop(value));
+        EXPECT_EQ(value, i);
+    }
+    int value;
+    EXPECT_FALSE(queue.Pop(value));
+    EXPECT_TRUE(queue.Empty());
+}
+
+TEST(LockFreeQueueTest, PopBatchStopsAtMaxCountAndEmpty) {
+    frc3512::LockFreeQueue<int> queue{8};
+    for (int i = 0; i < 6; ++i) {
+        EXPECT_TRUE(queue.Emplace(i));
+    }
+
+    std::array<int, 8> batch{};
+    ASSERT_EQ(queue.PopBatch(batch.begin(), 4), 4u);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(batch[i], i);
+    }
+
+    // The freed slots can be reused after the queue wraps around
+    for (int i = 6; i < 12; ++i) {
+        EXPECT_TRUE(queue.Emplace(i));
+    }
+    ASSERT_EQ(queue.PopBatch(batch.begin(), batch.size()), 8u);
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_EQ(batch[i], i + 4);
+    }
+
+    EXPECT_EQ(queue.PopBatch(batch.begin(), batch.size()), 0u);
+    EXPECT_TRUE(queue.Empty());
+}
+
+TEST(LockFreeQueueTest, MultipleProducers) {
+    constexpr int kProducers = 4;
+    constexpr int kValuesPerProducer = 10000;
+
+    frc3512::LockFreeQueue<int> queue{64};
+    std::vector<std::thread> producers;
+    for (int i = 0; i < kProducers; ++i) {
+        producers.emplace_back([&, i] {
+            for (int j = 0; j < kValuesPerProducer; ++j) {
+                while (!queue.Emplace(i * kValuesPerProducer + j)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // Values from each producer must arrive in the order they were pushed
+    std::vector<int> next(kProducers, 0);
+    int received = 0;
+    while (received < kProducers * kValuesPerProducer) {
+        queue.Consume([&](int& value) {
+            int producer = value / kValuesPerProducer;
+            EXPECT_EQ(value % kValuesPerProducer, next[producer]);
+            ++next[producer];
+            ++received;
+        });
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+}
+
+TEST(LockFreeQueueTest, MultipleProducersPopBatch) {
+    constexpr int kProducers = 4;
+    constexpr int kValuesPerProducer = 10000;
+
+    frc3512::LockFreeQueue<int> queue{64};
+    std::vector<std::thread> producers;
+    for (int i = 0; i < kProducers; ++i) {
+        producers.emplace_back([&, i] {
+            for (int j = 0; j < kValuesPerProducer; ++j) {
+                while (!queue.Emplace(i * kValuesPerProducer + j)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<int> next(kProducers, 0);
+    int received = 0;
+    std::array<int, 16> batch;
+    while (received < kProducers * kValuesPerProducer) {
+        size_t count = queue.PopBatch(batch.begin(), batch.size());
+        for (size_t i = 0; i < count; ++i) {
+            int producer = batch[i] / kValuesPerProducer;
+            EXPECT_EQ(batch[i] % kValuesPerProducer, next[producer]);
+            ++next[producer];
+            ++received;
+        }
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+}
@@ -0,0 +1,116 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <stdint.h>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "communications/AllFieldsPacket.hpp"
+
+namespace {
+
+frc3512::AllFieldsPacket MakePacket() {
+    frc3512::AllFieldsPacket packet;
+    packet.topic = "Fields";
+    packet.topicID = 42;
+    packet.sendTime = 123456789012;
+    packet.tiny = -5;
+    packet.flags = 0xA5;
+    packet.small = -1234;
+    packet.unsignedSmall = 0xBEEF;
+    packet.large = -9876543210123;
+    packet.unsignedLarge = 0xFEDCBA9876543210;
+    packet.ratio = 0.25f;
+    packet.enabled = true;
+    packet.point = {-3, 4, 1.5f};
+    packet.corners = {{{10, 20, 0.5f}, {-30, 40, -2.0f}}};
+    packet.counts = {1, -2, 300000};
+    packet.label = "front";
+    packet.afterLabel = -6.5;
+    packet.note = "";
+    return packet;
+}
+
+void ExpectPointEq(const frc3512::AllFieldsPoint& actual,
+                   const frc3512::AllFieldsPoint& expected) {
+    EXPECT_EQ(actual.x, expected.x);
+    EXPECT_EQ(actual.y, expected.y);
+    EXPECT_EQ(actual.weight, expected.weight);
+}
+
+void ExpectFieldsEq(const frc3512::AllFieldsPacket& actual,
+                    const frc3512::AllFieldsPacket& expected) {
+    EXPECT_EQ(actual.topicID, expected.topicID);
+    EXPECT_EQ(actual.sendTime, expected.sendTime);
+    EXPECT_EQ(actual.tiny, expected.tiny);
+    EXPECT_EQ(actual.flags, expected.flags);
+    EXPECT_EQ(actual.small, expected.small);
+    EXPECT_EQ(actual.unsignedSmall, expected.unsignedSmall);
+    EXPECT_EQ(actual.large, expected.large);
+    EXPECT_EQ(actual.unsignedLarge, expected.unsignedLarge);
+    EXPECT_EQ(actual.ratio, expected.ratio);
+    EXPECT_EQ(actual.enabled, expected.enabled);
+    ExpectPointEq(actual.point, expected.point);
+    ExpectPointEq(actual.corners[0], expected.corners[0]);
+    ExpectPointEq(actual.corners[1], expected.corners[1]);
+    EXPECT_EQ(actual.counts, expected.counts);
+    EXPECT_EQ(actual.label, expected.label);
+    EXPECT_EQ(actual.afterLabel, expected.afterLabel);
+    EXPECT_EQ(actual.note, expected.note);
+}
+
+}  // namespace
+
+TEST(MessageTest, RoundTripsThroughPacket) {
+    auto expected = MakePacket();
+    auto packet = expected.Serialize();
+    EXPECT_EQ(packet.getDataSize(), expected.WireSize());
+
+    frc3512::AllFieldsPacket actual{packet};
+    ExpectFieldsEq(actual, expected);
+}
+
+TEST(MessageTest, RoundTripsThroughBuffer) {
+    auto expected = MakePacket();
+
+    std::vector<char> buf(expected.WireSize());
+    EXPECT_EQ(expected.Serialize(buf.data(), buf.size() - 1), 0u);
+    ASSERT_EQ(expected.Serialize(buf.data(), buf.size()), buf.size());
+
+    frc3512::AllFieldsPacket actual;
+    actual.Deserialize(buf.data(), buf.size());
+    ExpectFieldsEq(actual, expected);
+}
+
+TEST(MessageTest, SizedScalarsAreBigEndian) {
+    auto packet = MakePacket().Serialize();
+    auto data = static_cast<const uint8_t*>(packet.getData());
+
+    // The header is a 1-byte ID, 4-byte topic ID and 8-byte send time,
+    // followed by tiny and flags
+    constexpr size_t kSmallOffset = 1 + 4 + 8 + 1 + 1;
+    EXPECT_EQ(data[kSmallOffset], 0xFB);  // -1234 is 0xFB2E
+    EXPECT_EQ(data[kSmallOffset + 1], 0x2E);
+    EXPECT_EQ(data[kSmallOffset + 2], 0xBE);
+    EXPECT_EQ(data[kSmallOffset + 3], 0xEF);
+}
+
+TEST(MessageTest, CutOffPacketIsRejected) {
+    auto packet = MakePacket().Serialize();
+    auto data = static_cast<const char*>(packet.getData());
+
+    // Cut off partway through the last string
+    frc3512::PacketReader reader{data, packet.getDataSize() - 1};
+    frc3512::AllFieldsPacket actual;
+    actual.Deserialize(reader);
+    EXPECT_FALSE(reader);
+}
+
+TEST(MessageTest, StandalonePacketHasNoPacketType) {
+    // AllFields is generated with --standalone, so its ID byte is one
+    // DeserializeAndProcessMessage() drops rather than a PacketType
+    auto packet = MakePacket().Serialize();
+    auto data = static_cast<const uint8_t*>(packet.getData());
+    EXPECT_EQ(data[0], 0xFF);
+}
@@ -0,0 +1,196 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "communications/ElevatorStatusPacket.hpp"
+#include "dsdisplay/Packet.hpp"
+#include "dsdisplay/PacketArena.hpp"
+#include "dsdisplay/PacketReader.hpp"
+
+TEST(PacketTest, ReadsBackWhatWasWritten) {
+    frc3512::Packet packet;
+    packet << static_cast<int32_t>(-7) << 2.5 << std::string("abc");
+
+    int32_t i;
+    double d;
+    std::string s;
+    packet >> i >> d >> s;
+    EXPECT_EQ(i, -7);
+    EXPECT_EQ(d, 2.5);
+    EXPECT_EQ(s, "abc");
+}
+
+TEST(PacketTest, SmallPacketsDontUseArena) {
+    frc3512::PacketArena arena{1024};
+
+    frc3512::ElevatorStatusPacket status;
+    status.topicID = 7;
+    status.distance = 1.5;
+    auto packet = status.Serialize(arena);
+    EXPECT_EQ(packet.getDataSize(), status.WireSize());
+    EXPECT_EQ(arena.Used(), 0u);
+
+    frc3512::ElevatorStatusPacket copy{packet};
+    EXPECT_EQ(copy.topicID, 7u);
+    EXPECT_EQ(copy.distance, 1.5);
+}
+
+TEST(PacketTest, SpillsIntoArenaThenHeap) {
+    frc3512::PacketArena arena{frc3512::Packet::kInlineSize * 2};
+    std::string large(frc3512::Packet::kInlineSize, 'x');
+
+    frc3512::Packet packet{arena};
+    packet << large;
+    EXPECT_GT(arena.Used(), 0u);
+
+    // The arena is too small for the next growth, so it goes to the heap
+    size_t used = arena.Used();
+    packet << large << large;
+    EXPECT_EQ(arena.Used(), used);
+
+    std::string s;
+    for (int i = 0; i < 3; ++i) {
+        packet >> s;
+        EXPECT_EQ(s, large);
+    }
+
+    arena.Reset();
+    EXPECT_EQ(arena.Used(), 0u);
+}
+
+TEST(PacketTest, CopiesAndMoves) {
+    frc3512::Packet small;
+    small << static_cast<uint32_t>(42);
+
+    frc3512::Packet large;
+    large << std::string(frc3512::Packet::kInlineSize * 2, 'y');
+
+    for (auto* original : {&small, &large}) {
+        frc3512::Packet copy{*original};
+        ASSERT_EQ(copy.getDataSize(), original->getDataSize());
+        EXPECT_NE(copy.getData(), original->getData());
+
+        const void* data = copy.getData();
+        frc3512::Packet moved{std::move(copy)};
+        EXPECT_EQ(moved.getDataSize(), original->getDataSize());
+        EXPECT_EQ(copy.getDataSize(), 0u);
+        if (original == &large) {
+            // Spilled storage changes hands instead of being copied
+            EXPECT_EQ(moved.getData(), data);
+        }
+
+        copy = moved;
+        EXPECT_EQ(copy.getDataSize(), original->getDataSize());
+    }
+}
+
+TEST(PacketTest, ReaderViewsStringsInPlace) {
+    frc3512::Packet packet;
+    packet << static_cast<int16_t>(-3) << std::string("abc") << true;
+
+    frc3512::PacketReader reader{packet};
+    int16_t i;
+    std::string_view s;
+    bool b = false;
+    reader >> i >> s >> b;
+    ASSERT_TRUE(reader);
+    EXPECT_EQ(i, -3);
+    EXPECT_EQ(s, "abc");
+    EXPECT_TRUE(b);
+    EXPECT_EQ(reader.Remaining(), 0u);
+
+    // The view points into the packet rather than a copy
+    auto data = static_cast<const char*>(packet.getData());
+    EXPECT_GE(s.data(), data);
+    EXPECT_LT(s.data(), data + packet.getDataSize());
+}
+
+TEST(PacketTest, ReaderStopsAtEnd) {
+    const char buf[] = {0, 0, 0, 9, 'a', 'b'};
+    frc3512::PacketReader reader{buf, sizeof(buf)};
+
+    // The string claims 9 bytes but only 2 follow
+    std::string_view s = "unchanged";
+    reader >> s;
+    EXPECT_FALSE(reader);
+    EXPECT_EQ(s, "unchanged");
+
+    uint8_t byte = 5;
+    reader >> byte;
+    EXPECT_EQ(byte, 5);
+}
+
+TEST(PacketTest, ReaderDeserializesConsecutivePackets) {
+    frc3512::ElevatorStatusPacket first;
+    first.distance = 1.0;
+    frc3512::ElevatorStatusPacket second;
+    second.distance = 2.0;
+
+    frc3512::Packet packet = first.Serialize();
+    auto serialized = second.Serialize();
+    packet.append(serialized.getData(), serialized.getDataSize());
+
+    frc3512::PacketReader reader{packet};
+    frc3512::ElevatorStatusPacket copy;
+    copy.Deserialize(reader);
+    EXPECT_EQ(copy.distance, 1.0);
+    copy.Deserialize(reader);
+    EXPECT_EQ(copy.distance, 2.0);
+    EXPECT_TRUE(reader);
+    EXPECT_EQ(reader.Remaining(), 0u);
+}
+
+TEST(PacketTest, ArraysMatchElementwiseEncoding) {
+    const int32_t ints[] = {1, -2, 0x12345678, -0x7fffffff};
+    const uint16_t shorts[] = {1, 0xabcd, 0};
+    const double doubles[] = {0.5, -1.25, 1e300};
+
+    frc3512::Packet bulk;
+    bulk.appendArray(ints, std::size(ints));
+    bulk.appendArray(shorts, std::size(shorts));
+    bulk.appendArray(doubles, std::size(doubles));
+
+    frc3512::Packet elementwise;
+    for (auto i : ints) {
+        elementwise << i;
+    }
+    for (auto s : shorts) {
+        elementwise << s;
+    }
+    for (auto d : doubles) {
+        elementwise << d;
+    }
+
+    ASSERT_EQ(bulk.getDataSize(), elementwise.getDataSize());
+    EXPECT_EQ(std::memcmp(bulk.getData(), elementwise.getData(),
+                          bulk.getDataSize()),
+              0);
+
+    int32_t intsCopy[std::size(ints)];
+    uint16_t shortsCopy[std::size(shorts)];
+    double doublesCopy[std::size(doubles)];
+    bulk.readArray(intsCopy, std::size(intsCopy))
+        .readArray(shortsCopy, std::size(shortsCopy))
+        .readArray(doublesCopy, std::size(doublesCopy));
+    EXPECT_TRUE(std::equal(std::begin(ints), std::end(ints), intsCopy));
+    EXPECT_TRUE(std::equal(std::begin(shorts), std::end(shorts), shortsCopy));
+    EXPECT_TRUE(
+        std::equal(std::begin(doubles), std::end(doubles), doublesCopy));
+
+    // Only part of the array is left
+    frc3512::PacketReader reader{elementwise};
+    reader.ReadBytes(sizeof(ints) + sizeof(shorts) + 1);
+    double unchanged[3] = {};
+    EXPECT_FALSE(reader.ReadArray(unchanged, std::size(unchanged)));
+    EXPECT_EQ(unchanged[0], 0.0);
+    EXPECT_FALSE(reader);
+}
@@ -0,0 +1,451 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "communications/PublishNode.hpp"
+
+namespace {
+
+class TestNode : public frc3512::PublishNode {
+public:
+    explicit TestNode(std::string_view name) : PublishNode(name) {}
+
+    ~TestNode() override { Stop(); }
+
+    void ProcessMessage(const frc3512::CommandPacket& message) override {
+        std::lock_guard lock(m_mutex);
+        m_order.push_back(-1);
+    }
+
+    void ProcessMessage(const frc3512::ButtonPacket& message) override {
+        {
+            std::lock_guard lock(m_mutex);
+            m_buttons.push_back(message);
+            m_order.push_back(message.button);
+        }
+
+        // Lets tests back up the node's queue
+        m_isBusy = true;
+        while (m_isHeld) {
+            std::this_thread::yield();
+        }
+        m_isBusy = false;
+    }
+
+    /**
+     * Makes the node's thread stall in ProcessMessage() until Release().
+     */
+    void Hold() { m_isHeld = true; }
+
+    /**
+     * Lets the node's thread resume processing messages.
+     */
+    void Release() { m_isHeld = false; }
+
+    /**
+     * Waits up to one second for the node's thread to stall in
+     * ProcessMessage().
+     */
+    bool WaitUntilBusy() {
+        for (int i = 0; i < 1000 && !m_isBusy; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return m_isBusy;
+    }
+
+    /**
+     * Waits up to one second for the given number of button messages.
+     */
+    std::vector<frc3512::ButtonPacket> WaitForButtons(size_t count) {
+        for (int i = 0; i < 1000; ++i) {
+            {
+                std::lock_guard lock(m_mutex);
+                if (m_buttons.size() >= count) {
+                    return m_buttons;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::lock_guard lock(m_mutex);
+        return m_buttons;
+    }
+
+    /**
+     * Returns the order messages were processed in. Buttons are recorded as
+     * their button number and commands as -1.
+     */
+    std::vector<int> GetOrder() {
+        std::lock_guard lock(m_mutex);
+        return m_order;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<frc3512::ButtonPacket> m_buttons;
+    std::vector<int> m_order;
+    std::atomic<bool> m_isHeld{false};
+    std::atomic<bool> m_isBusy{false};
+};
+
+/**
+ * Replies to every command which expects a reply.
+ */
+class ResponderNode : public frc3512::PublishNode {
+public:
+    ResponderNode() : PublishNode("Responder") {}
+
+    ~ResponderNode() override { Stop(); }
+
+    void ProcessMessage(const frc3512::CommandPacket& message) override {
+        if (!message.reply) {
+            Reply(message.requestID);
+        }
+    }
+};
+
+}  // namespace
+
+TEST(PublishNodeTest, DeliversMessagesInOrder) {
+    TestNode publisher{"Publisher"};
+    TestNode subscriber{"Subscriber"};
+    subscriber.Subscribe(publisher);
+
+    for (int i = 1; i <= 12; ++i) {
+        frc3512::ButtonPacket message{"Stick", i, i % 2 == 0};
+        publisher.Publish(message);
+    }
+
+    auto buttons = subscriber.WaitForButtons(12);
+    ASSERT_EQ(buttons.size(), 12u);
+    for (int i = 0; i < 12; ++i) {
+        EXPECT_EQ(buttons[i].topic, "Publisher/Stick");
+        EXPECT_EQ(buttons[i].topicID, frc3512::HashTopic("Publisher/Stick"));
+        EXPECT_EQ(buttons[i].button, i + 1);
+        EXPECT_EQ(buttons[i].pressed, (i + 1) % 2 == 0);
+    }
+}
+
+TEST(PublishNodeTest, PushMessageInternsTopic) {
+    TestNode node{"Node"};
+
+    {
+        // The caller's name is overwritten and freed while the packet's
+        // topic is still in use
+        std::string topic = "Robot/PushedStick";
+        node.PushMessage(frc3512::ButtonPacket{topic, 1, true});
+        topic.assign(topic.size(), 'x');
+    }
+
+    auto buttons = node.WaitForButtons(1);
+    ASSERT_EQ(buttons.size(), 1u);
+    EXPECT_EQ(buttons[0].topic, "Robot/PushedStick");
+    EXPECT_EQ(buttons[0].topicID, frc3512::HashTopic("Robot/PushedStick"));
+    EXPECT_EQ(frc3512::TopicRegistry::GetInstance().GetName(
+                  frc3512::HashTopic("Robot/PushedStick")),
+              "Robot/PushedStick");
+}
+
+TEST(PublishNodeTest, Unsubscribe) {
+    TestNode publisher{"Publisher"};
+    TestNode subscriber{"Subscriber"};
+    subscriber.Subscribe(publisher);
+    subscriber.Unsubscribe(publisher);
+
+    frc3512::ButtonPacket message{"Stick", 1, true};
+    publisher.Publish(message);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(subscriber.WaitForButtons(0).size(), 0u);
+}
+
+TEST(PublishNodeTest, FiltersByTypeAndTopic) {
+    TestNode publisher{"Publisher"};
+    TestNode subscriber{"Subscriber"};
+    subscriber.Subscribe(publisher, {{frc3512::PacketType::kButton},
+                                     {frc3512::HashTopic("Publisher/Stick2")}});
+
+    frc3512::ButtonPacket rejected{"Stick1", 1, true};
+    frc3512::ButtonPacket accepted{"Stick2", 2, true};
+    publisher.Publish(rejected);
+    publisher.Publish(accepted);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto buttons = subscriber.WaitForButtons(1);
+    ASSERT_EQ(buttons.size(), 1u);
+    EXPECT_EQ(buttons[0].topic, "Publisher/Stick2");
+
+    // Subscribing again replaces the filter
+    subscriber.Subscribe(publisher, {frc3512::PacketType::kCommand});
+    publisher.Publish(accepted);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(subscriber.WaitForButtons(0).size(), 1u);
+}
+
+TEST(PublishNodeTest, DropOldestKeepsNewestMessages) {
+    constexpr int kMessages = 100;
+
+    TestNode publisher{"Publisher"};
+    TestNode subscriber{"Subscriber"};
+    subscriber.Subscribe(publisher);
+
+    subscriber.Hold();
+    frc3512::ButtonPacket message{"Stick", 0, true};
+    publisher.Publish(message);
+    ASSERT_TRUE(subscriber.WaitUntilBusy());
+
+    for (int i = 1; i <= kMessages; ++i) {
+        message.button = i;
+        publisher.Publish(message);
+    }
+    subscriber.Release();
+
+    constexpr int kQueued = frc3512::PublishNode::kNodeQueueSize;
+    auto buttons = subscriber.WaitForButtons(kQueued + 1);
+    ASSERT_EQ(buttons.size(), static_cast<size_t>(kQueued + 1));
+    EXPECT_EQ(buttons[1].button, kMessages - kQueued + 1);
+    EXPECT_EQ(buttons.back().button, kMessages);
+    EXPECT_EQ(subscriber.GetDropCount(frc3512::PacketType::kButton),
+              static_cast<uint64_t>(kMessages - kQueued));
+}
+
+TEST(PublishNodeTest, LatestKeepsOnlyNewestPerTopic) {
+    TestNode publisher{"Publisher"};
+    TestNode subscriber{"Subscriber"};
+    subscriber.Subscribe(publisher);
+    subscriber.SetOverflowPolicy(frc3512::PacketType::kButton,
+                                 frc3512::OverflowPolicy::kLatest);
+
+    subscriber.Hold();
+    frc3512::ButtonPacket message{"Stick1", 0, true};
+    publisher.Publish(message);
+    ASSERT_TRUE(subscriber.WaitUntilBusy());
+
+    for (int i = 1; i <= 10; ++i) {
+        message.topic = "Stick1";
+        message.button = i;
+        publisher.Publish(message);
+        message.topic = "Stick2";
+        message.button = 100 + i;
+        publisher.Publish(message);
+    }
+    subscriber.Release();
+
+    auto buttons = subscriber.WaitForButtons(3);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    buttons = subscriber.WaitForButtons(3);
+    ASSERT_EQ(buttons.size(), 3u);
+    EXPECT_EQ(buttons[1].topic, "Publisher/Stick1");
+    EXPECT_EQ(buttons[1].button, 10);
+    EXPECT_EQ(buttons[2].topic, "Publisher/Stick2");
+    EXPECT_EQ(buttons[2].button, 110);
+    EXPECT_EQ(subscriber.GetDropCount(frc3512::PacketType::kButton), 18u);
+}
+
+TEST(PublishNodeTest, CommandsBypassBacklog) {
+    TestNode publisher{"Publisher"};
+    TestNode subscriber{"Subscriber"};
+    subscriber.Subscribe(publisher);
+
+    subscriber.Hold();
+    frc3512::ButtonPacket button{"Stick", 0, true};
+    publisher.Publish(button);
+    ASSERT_TRUE(subscriber.WaitUntilBusy());
+
+    for (int i = 1; i <= 10; ++i) {
+        button.button = i;
+        publisher.Publish(button);
+    }
+    frc3512::CommandPacket command{"DisabledInit", true, 0};
+    publisher.Publish(command);
+
+    EXPECT_EQ(subscriber.GetQueueDepth(frc3512::MessagePriority::kNormal),
+              10u);
+    EXPECT_EQ(subscriber.GetQueueDepth(frc3512::MessagePriority::kHigh), 1u);
+    subscriber.Release();
+
+    subscriber.WaitForButtons(11);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto order = subscriber.GetOrder();
+    ASSERT_EQ(order.size(), 12u);
+    EXPECT_EQ(order[0], 0);
+    EXPECT_EQ(order[1], -1);
+    EXPECT_EQ(order[2], 1);
+    EXPECT_EQ(subscriber.GetMaxQueueDepth(frc3512::MessagePriority::kNormal),
+              10u);
+}
+
+TEST(PublishNodeTest, Stats) {
+    TestNode publisher{"Publisher"};
+    TestNode subscriber{"Subscriber"};
+    subscriber.Subscribe(publisher);
+
+    frc3512::ButtonPacket button{"Stick", 1, true};
+    for (int i = 0; i < 5; ++i) {
+        publisher.Publish(button);
+    }
+    subscriber.WaitForButtons(5);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    auto buttonIndex = static_cast<size_t>(frc3512::PacketType::kButton);
+    auto published = publisher.GetStats();
+    EXPECT_EQ(published.nodeName, "Publisher");
+    EXPECT_EQ(published.types[buttonIndex].published, 5u);
+    EXPECT_EQ(published.types[buttonIndex].received, 0u);
+
+    auto received = subscriber.GetStats();
+    auto& buttonStats = received.types[buttonIndex];
+    EXPECT_EQ(buttonStats.received, 5u);
+    EXPECT_EQ(buttonStats.bytesEnqueued, 5 * sizeof(frc3512::ButtonPacket));
+    EXPECT_EQ(buttonStats.queueLatency.Count(), 5u);
+    EXPECT_EQ(buttonStats.processingTime.Count(), 5u);
+    EXPECT_GE(received.maxQueueDepth[1], 1u);
+}
+
+TEST(PublishNodeTest, DropsStaleMessages) {
+    TestNode publisher{"Publisher"};
+    TestNode subscriber{"Subscriber"};
+    subscriber.Subscribe(publisher);
+    subscriber.SetMaxAge(frc3512::PacketType::kButton,
+                         std::chrono::milliseconds(10));
+
+    subscriber.Hold();
+    frc3512::ButtonPacket button{"Stick", 0, true};
+    publisher.Publish(button);
+    ASSERT_TRUE(subscriber.WaitUntilBusy());
+
+    // These wait behind the held message until they're stale
+    for (int i = 1; i <= 3; ++i) {
+        button.button = i;
+        publisher.Publish(button);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    subscriber.Release();
+
+    button.button = 4;
+    publisher.Publish(button);
+    auto buttons = subscriber.WaitForButtons(2);
+    ASSERT_EQ(buttons.size(), 2u);
+    EXPECT_EQ(buttons[1].button, 4);
+    EXPECT_NE(buttons[1].sendTime, 0);
+    EXPECT_EQ(subscriber.GetDropCount(frc3512::PacketType::kButton), 3u);
+}
+
+TEST(PublishNodeTest, TracksDeliveryLatencyPerPublisher) {
+    TestNode publisher1{"Publisher1"};
+    TestNode publisher2{"Publisher2"};
+    TestNode subscriber{"Subscriber"};
+    subscriber.Subscribe(publisher1);
+    subscriber.Subscribe(publisher2);
+
+    frc3512::ButtonPacket button{"Stick", 1, true};
+    for (int i = 0; i < 3; ++i) {
+        publisher1.Publish(button);
+    }
+    publisher2.Publish(button);
+    subscriber.PushMessage(button);
+    subscriber.WaitForButtons(5);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // Pushed messages don't have a publisher, so they aren't counted
+    auto stats = subscriber.GetStats();
+    ASSERT_EQ(stats.edges.size(), 2u);
+    EXPECT_EQ(stats.edges[0].publisher, "Publisher1");
+    EXPECT_EQ(stats.edges[0].deliveryLatency.Count(), 3u);
+    EXPECT_EQ(stats.edges[1].publisher, "Publisher2");
+    EXPECT_EQ(stats.edges[1].deliveryLatency.Count(), 1u);
+    EXPECT_TRUE(publisher1.GetStats().edges.empty());
+}
+
+TEST(PublishNodeTest, DeserializeAndProcessIgnoresUnknownTypes) {
+    TestNode node{"Node"};
+
+    frc3512::ButtonPacket button{"Stick", 3, true};
+    auto packet = button.Serialize();
+    node.DeserializeAndProcessMessage(
+        static_cast<const char*>(packet.getData()), packet.getDataSize());
+
+    // One past the last PacketType, and a type that's negative as an int8_t
+    for (char type : {static_cast<char>(std::size(frc3512::kPacketTypeNames)),
+                      static_cast<char>(-1)}) {
+        const char unknown[] = {type, 0, 0, 0, 0};
+        node.DeserializeAndProcessMessage(unknown, sizeof(unknown));
+    }
+    node.DeserializeAndProcessMessage(nullptr, 0);
+
+    auto order = node.GetOrder();
+    ASSERT_EQ(order.size(), 1u);
+    EXPECT_EQ(order[0], 3);
+}
+
+TEST(PublishNodeTest, SerializesIntoBuffer) {
+    frc3512::HIDPacket hid{"Stick", {1.0, 2.0, 3.0, 4.0}, {-1.0, 0.5, 0.0, 8.0},
+                           {1, 0, 7, -3}};
+    hid.topicID = 42;
+    hid.sendTime = 123456789012;
+    auto packet = hid.Serialize();
+    ASSERT_EQ(packet.getDataSize(), hid.WireSize());
+
+    char buf[frc3512::HIDPacket::kWireSize];
+    EXPECT_EQ(hid.Serialize(buf, sizeof(buf) - 1), 0u);
+    ASSERT_EQ(hid.Serialize(buf, sizeof(buf)), sizeof(buf));
+    EXPECT_EQ(std::memcmp(buf, packet.getData(), sizeof(buf)), 0);
+
+    frc3512::HIDPacket copy;
+    copy.Deserialize(buf, sizeof(buf));
+    EXPECT_EQ(copy.topicID, 42u);
+    EXPECT_EQ(copy.sendTime, hid.sendTime);
+    EXPECT_EQ(copy.x, hid.x);
+    EXPECT_EQ(copy.y, hid.y);
+    EXPECT_EQ(copy.buttons, hid.buttons);
+}
+
+TEST(PublishNodeTest, RequestReceivesReply) {
+    TestNode requester{"Requester"};
+    ResponderNode responder;
+    responder.Subscribe(requester);
+    requester.Subscribe(responder);
+
+    auto future = requester.Request(frc3512::CommandPacket{"Ping", false, 0},
+                                    std::chrono::seconds(1));
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(1)),
+              std::future_status::ready);
+    EXPECT_TRUE(future.get());
+
+    uint32_t replyID = 0;
+    std::promise<void> replied;
+    uint32_t requestID = requester.Request(
+        frc3512::CommandPacket{"Ping", false, 0}, std::chrono::seconds(1),
+        [&](const frc3512::CommandPacket* reply) {
+            replyID = reply != nullptr ? reply->requestID : 0;
+            replied.set_value();
+        });
+    replied.get_future().wait();
+    EXPECT_EQ(replyID, requestID);
+
+    // Replies go to the request's callback rather than ProcessMessage()
+    EXPECT_TRUE(requester.GetOrder().empty());
+}
+
+TEST(PublishNodeTest, RequestTimesOut) {
+    TestNode requester{"Requester"};
+
+    auto startTime = std::chrono::steady_clock::now();
+    auto future = requester.Request(frc3512::CommandPacket{"Ping", false, 0},
+                                    std::chrono::milliseconds(20));
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(1)),
+              std::future_status::ready);
+    EXPECT_FALSE(future.get());
+    EXPECT_GE(std::chrono::steady_clock::now() - startTime,
+              std::chrono::milliseconds(20));
+}
@@ -0,0 +1,243 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "communications/Blackboard.hpp"
+#include "communications/PublishNode.hpp"
+#include "communications/Recorder.hpp"
+#include "communications/Replayer.hpp"
+
+using namespace frc3512;
+
+namespace {
+
+constexpr char kRecording[] = "RecorderTest.rec";
+
+class ButtonNode : public PublishNode {
+public:
+    explicit ButtonNode(std::string_view name) : PublishNode(name) {}
+
+    ~ButtonNode() override { Stop(); }
+
+    void ProcessMessage(const ButtonPacket& message) override {
+        std::lock_guard lock(m_mutex);
+        m_buttons.push_back(message.button);
+        m_topics.push_back(message.topicID);
+    }
+
+    /**
+     * Waits up to one second for the given number of button messages.
+     */
+    std::vector<int> WaitForButtons(size_t count) {
+        for (int i = 0; i < 1000; ++i) {
+            {
+                std::lock_guard lock(m_mutex);
+                if (m_buttons.size() >= count) {
+                    break;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::lock_guard lock(m_mutex);
+        return m_buttons;
+    }
+
+    std::vector<TopicID> GetTopics() {
+        std::lock_guard lock(m_mutex);
+        return m_topics;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<int> m_buttons;
+    std::vector<TopicID> m_topics;
+};
+
+/**
+ * Requests "First", then "Second" once "First" is answered, and records which
+ * callbacks ran.
+ */
+class RequesterNode : public PublishNode {
+public:
+    RequesterNode() : PublishNode("ReplayRequester") {}
+
+    ~RequesterNode() override { Stop(); }
+
+    void ProcessMessage(const CommandPacket& message) override {
+        ++m_dispatchedCommands;
+    }
+
+    void Start() {
+        Request(CommandPacket{"First", false, 0}, std::chrono::seconds(5),
+                [this](const CommandPacket* reply) {
+                    AddResult(reply != nullptr ? "First" : "First timed out");
+                    Request(CommandPacket{"Second", false, 0},
+                            std::chrono::seconds(5),
+                            [this](const CommandPacket* reply) {
+                                AddResult(reply != nullptr
+                                              ? "Second"
+                                              : "Second timed out");
+                            });
+                });
+    }
+
+    /**
+     * Waits up to one second for the given number of callbacks.
+     */
+    std::vector<std::string> WaitForResults(size_t count) {
+        for (int i = 0; i < 1000; ++i) {
+            {
+                std::lock_guard lock(m_mutex);
+                if (m_results.size() >= count) {
+                    break;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::lock_guard lock(m_mutex);
+        return m_results;
+    }
+
+    int GetDispatchedCommands() const { return m_dispatchedCommands; }
+
+private:
+    std::mutex m_mutex;
+    std::vector<std::string> m_results;
+    std::atomic<int> m_dispatchedCommands{0};
+
+    void AddResult(std::string result) {
+        std::lock_guard lock(m_mutex);
+        m_results.emplace_back(std::move(result));
+    }
+};
+
+/**
+ * Replies to every command which expects a reply.
+ */
+class ResponderNode : public PublishNode {
+public:
+    ResponderNode() : PublishNode("ReplayResponder") {}
+
+    ~ResponderNode() override { Stop(); }
+
+    void ProcessMessage(const CommandPacket& message) override {
+        if (!message.reply) {
+            Reply(message.requestID);
+        }
+    }
+};
+
+}  // namespace
+
+TEST(RecorderTest, ReplaysDeliveriesAndPublications) {
+    {
+        ButtonNode publisher{"RecordedPublisher"};
+        ButtonNode subscriber{"RecordedSubscriber"};
+        ButtonNode other{"RecordedOther"};
+        subscriber.Subscribe(publisher);
+        other.Subscribe(publisher);
+
+        auto& recorder = Recorder::GetInstance();
+        ASSERT_TRUE(recorder.Start(kRecording));
+        for (int i = 1; i <= 5; ++i) {
+            publisher.Publish(ButtonPacket{"Stick", i, true});
+        }
+        publisher.Publish(ElevatorStatusPacket{"Status", 1.5, 0.0, false,
+                                               false});
+        ASSERT_EQ(subscriber.WaitForButtons(5).size(), 5u);
+        recorder.Stop();
+        EXPECT_EQ(recorder.GetDropCount(), 0u);
+
+        // Published after recording stopped, so replay should overwrite it
+        publisher.Publish(ElevatorStatusPacket{"Status", 2.5, 0.0, false,
+                                               false});
+    }
+
+    // Only the subscriber is added, so messages recorded for the other node
+    // are skipped
+    ButtonNode subscriber{"RecordedSubscriber"};
+    Replayer replayer{kRecording};
+    ASSERT_TRUE(replayer.IsOpen());
+    replayer.AddNode(subscriber);
+
+    // Five buttons and the status packet
+    EXPECT_EQ(replayer.Run(), 6u);
+
+    // Replay runs on this thread, so everything was delivered on return
+    EXPECT_EQ(subscriber.WaitForButtons(0), (std::vector<int>{1, 2, 3, 4, 5}));
+    for (auto topic : subscriber.GetTopics()) {
+        EXPECT_EQ(topic, "RecordedPublisher/Stick"_topic);
+    }
+
+    ElevatorStatusPacket status;
+    ASSERT_TRUE(Blackboard::GetInstance().Read("RecordedPublisher/Status"_topic,
+                                               status));
+    EXPECT_EQ(status.distance, 1.5);
+
+    // A recording can be replayed more than once
+    EXPECT_EQ(replayer.Run(), 6u);
+
+    std::remove(kRecording);
+}
+
+TEST(RecorderTest, RealTimeReplayKeepsSpacing) {
+    {
+        ButtonNode publisher{"SpacedPublisher"};
+        ButtonNode subscriber{"SpacedSubscriber"};
+        subscriber.Subscribe(publisher);
+
+        ASSERT_TRUE(Recorder::GetInstance().Start(kRecording));
+        publisher.Publish(ButtonPacket{"Stick", 1, true});
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        publisher.Publish(ButtonPacket{"Stick", 2, true});
+        Recorder::GetInstance().Stop();
+    }
+
+    ButtonNode subscriber{"SpacedSubscriber"};
+    Replayer replayer{kRecording};
+    replayer.AddNode(subscriber);
+
+    auto startTime = std::chrono::steady_clock::now();
+    EXPECT_EQ(replayer.Run(ReplaySpeed::kRealTime), 2u);
+    EXPECT_GE(std::chrono::steady_clock::now() - startTime,
+              std::chrono::milliseconds(45));
+
+    std::remove(kRecording);
+}
+
+TEST(RecorderTest, ReplaysRepliesToRequests) {
+    const std::vector<std::string> expected{"First", "Second"};
+    {
+        RequesterNode requester;
+        ResponderNode responder;
+        responder.Subscribe(requester, {PacketType::kCommand});
+        requester.Subscribe(responder, {PacketType::kCommand});
+
+        ASSERT_TRUE(Recorder::GetInstance().Start(kRecording));
+        requester.Start();
+        ASSERT_EQ(requester.WaitForResults(2), expected);
+        Recorder::GetInstance().Stop();
+    }
+
+    // The replayed node makes its first request itself. Its IDs differ from
+    // the recorded ones, but the recorded replies still reach its callbacks.
+    RequesterNode requester;
+    Replayer replayer{kRecording};
+    replayer.AddNode(requester);
+    requester.Start();
+    EXPECT_EQ(replayer.Run(), 2u);
+
+    EXPECT_EQ(requester.WaitForResults(0), expected);
+    EXPECT_EQ(requester.GetDispatchedCommands(), 0);
+
+    std::remove(kRecording);
+}
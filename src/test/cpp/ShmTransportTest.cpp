@@ -0,0 +1,124 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <variant>
+
+#include <gtest/gtest.h>
+
+#include "communications/ShmTransport.hpp"
+
+using namespace frc3512;
+
+TEST(ShmTransportTest, ReadsMessagesInOrder) {
+    ShmWriter writer{"/frc3512-test-order", 16};
+    ASSERT_TRUE(writer.IsOpen());
+    ShmReader reader{"/frc3512-test-order"};
+    ASSERT_TRUE(reader.IsOpen());
+
+    ButtonPacket button{"Robot/Stick", 0, true};
+    button.topicID = "Robot/Stick"_topic;
+    for (int i = 0; i < 5; ++i) {
+        button.button = i;
+        writer.Write(button);
+    }
+
+    for (int i = 0; i < 5; ++i) {
+        int received = -1;
+        EXPECT_TRUE(reader.Read([&](const Message& message) {
+            auto& packet = std::get<ButtonPacket>(message);
+            EXPECT_EQ(packet.topicID, "Robot/Stick"_topic);
+            EXPECT_TRUE(packet.topic.empty());
+            received = packet.button;
+        }));
+        EXPECT_EQ(received, i);
+    }
+    EXPECT_FALSE(reader.Read([](const Message&) {}));
+    EXPECT_EQ(reader.GetLostCount(), 0u);
+}
+
+TEST(ShmTransportTest, LappedReaderSkipsAhead) {
+    ShmWriter writer{"/frc3512-test-lapped", 8};
+    ShmReader reader{"/frc3512-test-lapped"};
+
+    ButtonPacket button{"Stick", 0, true};
+    for (int i = 0; i < 20; ++i) {
+        button.button = i;
+        writer.Write(button);
+    }
+
+    // Only the last lap is left
+    int first = -1;
+    ASSERT_TRUE(reader.Read([&](const Message& message) {
+        first = std::get<ButtonPacket>(message).button;
+    }));
+    EXPECT_EQ(first, 12);
+    EXPECT_EQ(reader.GetLostCount(), 12u);
+}
+
+TEST(ShmTransportTest, WaitWakesOnWrite) {
+    ShmWriter writer{"/frc3512-test-wait", 16};
+    ShmReader reader{"/frc3512-test-wait"};
+
+    EXPECT_FALSE(reader.Wait(std::chrono::milliseconds(1)));
+
+    std::thread publisher([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        writer.Write(CommandPacket{"DisabledInit", true, 0});
+    });
+    auto startTime = std::chrono::steady_clock::now();
+    EXPECT_TRUE(reader.Wait(std::chrono::seconds(5)));
+    EXPECT_LT(std::chrono::steady_clock::now() - startTime,
+              std::chrono::seconds(1));
+    publisher.join();
+
+    EXPECT_TRUE(reader.Read([](const Message& message) {
+        EXPECT_TRUE(std::holds_alternative<CommandPacket>(message));
+    }));
+}
+
+TEST(ShmTransportTest, ReaderRejectsMissingRing) {
+    ShmReader reader{"/frc3512-test-missing"};
+    EXPECT_FALSE(reader.IsOpen());
+    EXPECT_FALSE(reader.Read([](const Message&) {}));
+}
+
+TEST(ShmTransportTest, SlotsHoldSerializedPackets) {
+    ShmWriter writer{"/frc3512-test-layout", 8};
+    ButtonPacket button{"Robot/Stick", 3, true};
+    button.topicID = "Robot/Stick"_topic;
+    writer.Write(button);
+
+    // Map the ring like an off-robot tool would
+    int fd = shm_open("/frc3512-test-layout", O_RDWR, 0);
+    ASSERT_NE(fd, -1);
+    size_t size = ShmRing::MappingSize(8);
+    void* mapping =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT_NE(mapping, MAP_FAILED);
+
+    auto header = static_cast<ShmRing::Header*>(mapping);
+    EXPECT_EQ(header->schemaHash, kSchemaHash);
+    auto& slot = *reinterpret_cast<ShmRing::Slot*>(header + 1);
+    EXPECT_EQ(slot.sequence.load(), 2u);
+    ASSERT_EQ(slot.size, ButtonPacket::kWireSize);
+
+    ButtonPacket expected = button;
+    char data[ButtonPacket::kWireSize];
+    ASSERT_EQ(expected.Serialize(data, sizeof(data)), sizeof(data));
+    EXPECT_EQ(slot.data[0], static_cast<char>(PacketType::kButton));
+    EXPECT_EQ(std::memcmp(slot.data, data, sizeof(data)), 0);
+
+    // A reader built from a different schema refuses the ring
+    header->schemaHash = kSchemaHash + 1;
+    ShmReader reader{"/frc3512-test-layout"};
+    EXPECT_FALSE(reader.IsOpen());
+
+    munmap(mapping, size);
+}
@@ -0,0 +1,134 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <stdint.h>
+
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "dsdisplay/Packet.hpp"
+#include "dsdisplay/PacketReader.hpp"
+#include "dsdisplay/TelemetryCodec.hpp"
+
+namespace {
+
+struct Frame {
+    double position;
+    double velocity;
+    int64_t count;
+};
+
+std::vector<Frame> MakeFrames(int count) {
+    std::vector<Frame> frames;
+    for (int i = 0; i < count; ++i) {
+        frames.push_back({0.01 * i, i < count / 2 ? 1.5 : 0.0, 1000 + i});
+    }
+    return frames;
+}
+
+void EncodeFrame(frc3512::TelemetryEncoder& encoder, frc3512::Packet& packet,
+                 const Frame& frame) {
+    encoder.BeginFrame(packet);
+    encoder.EncodeDouble(packet, frame.position);
+    encoder.EncodeDouble(packet, frame.velocity);
+    encoder.EncodeInteger(packet, frame.count);
+}
+
+bool DecodeFrame(frc3512::TelemetryDecoder& decoder,
+                 frc3512::PacketReader& reader, Frame& frame) {
+    return decoder.BeginFrame(reader) &&
+           decoder.DecodeDouble(reader, frame.position) &&
+           decoder.DecodeDouble(reader, frame.velocity) &&
+           decoder.DecodeInteger(reader, frame.count);
+}
+
+}  // namespace
+
+TEST(TelemetryCodecTest, RoundTripsLosslessly) {
+    frc3512::TelemetryEncoder encoder{10};
+    frc3512::TelemetryDecoder decoder;
+
+    size_t encodedSize = 0;
+    for (const auto& frame : MakeFrames(100)) {
+        frc3512::Packet packet;
+        EncodeFrame(encoder, packet, frame);
+        encodedSize += packet.getDataSize();
+
+        frc3512::PacketReader reader{packet};
+        Frame decoded;
+        ASSERT_TRUE(DecodeFrame(decoder, reader, decoded));
+        EXPECT_EQ(decoded.position, frame.position);
+        EXPECT_EQ(decoded.velocity, frame.velocity);
+        EXPECT_EQ(decoded.count, frame.count);
+    }
+
+    // Uncompressed, each frame is two doubles and an int64_t
+    EXPECT_LT(encodedSize, 100 * 24u);
+}
+
+TEST(TelemetryCodecTest, HandlesExtremeValues) {
+    frc3512::TelemetryEncoder encoder;
+    frc3512::TelemetryDecoder decoder;
+
+    const double doubles[] = {0.0, -0.0, std::numeric_limits<double>::max(),
+                              std::numeric_limits<double>::infinity(), 1e-300};
+    const int64_t ints[] = {0, std::numeric_limits<int64_t>::min(),
+                            std::numeric_limits<int64_t>::max(), -1, 1};
+
+    for (size_t i = 0; i < std::size(doubles); ++i) {
+        frc3512::Packet packet;
+        encoder.BeginFrame(packet);
+        encoder.EncodeDouble(packet, doubles[i]);
+        encoder.EncodeInteger(packet, ints[i]);
+
+        frc3512::PacketReader reader{packet};
+        double d;
+        int64_t n;
+        ASSERT_TRUE(decoder.BeginFrame(reader));
+        ASSERT_TRUE(decoder.DecodeDouble(reader, d));
+        ASSERT_TRUE(decoder.DecodeInteger(reader, n));
+        EXPECT_EQ(std::signbit(d), std::signbit(doubles[i]));
+        EXPECT_EQ(d, doubles[i]);
+        EXPECT_EQ(n, ints[i]);
+    }
+}
+
+TEST(TelemetryCodecTest, ResynchronizesAtKeyframe) {
+    frc3512::TelemetryEncoder encoder{4};
+    frc3512::TelemetryDecoder decoder;
+    auto frames = MakeFrames(8);
+
+    for (size_t i = 0; i < frames.size(); ++i) {
+        frc3512::Packet packet;
+        EncodeFrame(encoder, packet, frames[i]);
+
+        // Frame 1 is lost, so frames 2 and 3 can't be decoded
+        if (i == 1) {
+            continue;
+        }
+
+        frc3512::PacketReader reader{packet};
+        Frame decoded;
+        bool isDecoded = DecodeFrame(decoder, reader, decoded);
+        EXPECT_EQ(isDecoded, i != 2 && i != 3) << "frame " << i;
+        if (isDecoded) {
+            EXPECT_EQ(decoded.position, frames[i].position);
+            EXPECT_EQ(decoded.count, frames[i].count);
+        }
+    }
+}
+
+TEST(TelemetryCodecTest, RejectsTruncatedFrames) {
+    frc3512::TelemetryEncoder encoder;
+    frc3512::Packet packet;
+    EncodeFrame(encoder, packet, {1.0, 2.0, 3});
+
+    frc3512::TelemetryDecoder decoder;
+    frc3512::PacketReader reader{static_cast<const char*>(packet.getData()),
+                                 packet.getDataSize() - 1};
+    Frame decoded;
+    EXPECT_FALSE(DecodeFrame(decoder, reader, decoded));
+}
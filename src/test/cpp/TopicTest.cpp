@@ -0,0 +1,32 @@
+// Copyright (c) 2020 FRC Team 3512. All Rights Reserved.
+
+#include <gtest/gtest.h>
+
+#include "communications/Topic.hpp"
+
+using namespace frc3512;
+
+TEST(TopicTest, HashMatchesFnv1a) {
+    static_assert("a"_topic == 0xe40c292c);
+    EXPECT_EQ(HashTopic("foobar"), 0xbf9cf968u);
+}
+
+TEST(TopicTest, PrefixHashContinues) {
+    uint32_t prefix = FnvAppend(FnvAppend(kFnvOffsetBasis, "Robot"), "/");
+    EXPECT_EQ(MakeTopicID(FnvAppend(prefix, "AppendageStick2")),
+              "Robot/AppendageStick2"_topic);
+}
+
+TEST(TopicTest, RegistryInternsNames) {
+    auto& registry = TopicRegistry::GetInstance();
+
+    constexpr TopicID id = "TopicTest/Name"_topic;
+    EXPECT_EQ(registry.GetName(id), "");
+
+    auto name = registry.Intern(id, "TopicTest", "Name");
+    EXPECT_EQ(name, "TopicTest/Name");
+    EXPECT_EQ(registry.GetName(id), "TopicTest/Name");
+
+    // Interning again returns the same storage
+    EXPECT_EQ(registry.Intern(id, "TopicTest", "Name").data(), name.data());
+}